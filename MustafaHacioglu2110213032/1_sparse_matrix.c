@@ -1,8 +1,47 @@
+// Build: gcc -O2 -pthread 1_sparse_matrix.c -o sparse_matrix -lm
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SPMV_X86 1
+#endif
 
 #define MAX_TERMS 100
 
+// SpMV kernel identifiers
+#define SPMV_SCALAR 0
+#define SPMV_SSE2 1
+#define SPMV_AVX2 2
+
+// Element-wise merge operations
+#define SPARSE_ADD 0
+#define SPARSE_SUBTRACT 1
+#define SPARSE_HADAMARD 2
+
+// Block-sparse tile edge, override with -DBSR_BLOCK=8 etc.
+#ifndef BSR_BLOCK
+#define BSR_BLOCK 4
+#endif
+
+// Deltas decoded per refill of an encoded-matrix iterator
+#define ENCODED_BATCH 64
+
+// Worker thread limit for parallel conversion and loading
+#define MAX_THREADS 64
+
+// Matrix Market writer buffer size
+#define MTX_WRITE_BUFFER (1 << 20)
+
 // Sparse matrix element structure
 typedef struct {
     int row;
@@ -10,100 +49,3236 @@ typedef struct {
     int value;
 } SparseElement;
 
-// Function to convert regular matrix to sparse matrix
-int convertToSparse(int matrix[][10], int rows, int cols, SparseElement sparse[]) {
-    int k = 0; // Index for sparse array
+// Compressed sparse structure: CSR (row pointers) or CSC (column pointers)
+typedef struct {
+    int rows;
+    int cols;
+    int nnz;
+    int* ptr;          // Offsets into idx/values, rows+1 (CSR) or cols+1 (CSC) entries
+    int* idx;          // Column index (CSR) or row index (CSC) of each value
+    int* values;
+    int isColumnMajor; // 1 for CSC, 0 for CSR
+} CompressedMatrix;
+
+// Block compressed sparse row (BSR): dense BSR_BLOCK x BSR_BLOCK tiles
+typedef struct {
+    int rows;
+    int cols;
+    int blockRows;     // ceil(rows / BSR_BLOCK)
+    int blockCols;     // ceil(cols / BSR_BLOCK)
+    int numBlocks;
+    int nnz;           // Non-zeros before padding tiles with zeros
+    int* blockPtr;     // blockRows+1 offsets into blockCol
+    int* blockCol;     // Block column of each tile
+    double* values;    // numBlocks tiles, each column-major BSR_BLOCK*BSR_BLOCK
+} BlockMatrix;
+
+// Delta/varint encoded matrix: entries sorted row-major, each stored as the
+// gap to the previous linear index (row * cols + col) minus one, LEB128 coded.
+// A storage format: it is about a third smaller than CSR, but decoding costs
+// more than the saved bytes, so SpMV on it is slower than on CSR.
+typedef struct {
+    long long rows;
+    long long cols;
+    long long count;
+    long long numBytes;
+    unsigned char* bytes;  // Encoded index gaps
+    int* values;           // Values in the same order
+} EncodedMatrix;
+
+// Streaming reader over an EncodedMatrix, decoding in small batches
+typedef struct {
+    EncodedMatrix* m;
+    long long offset;      // Next byte to decode
+    long long index;       // Entries returned so far
+    long long row;         // Position of the last returned entry
+    long long col;
+    unsigned long long deltas[ENCODED_BATCH];
+    int batchPos;
+    int batchLen;
+} EncodedIterator;
+
+// Bitmap-indexed matrix: one occupancy bit per element plus the non-zero
+// values packed in row-major order. wordRank gives the number of set bits
+// before each 64-bit word, so any element is found with one popcount.
+typedef struct {
+    int rows;
+    int cols;
+    int wordsPerRow;             // ceil(cols / 64)
+    int nnz;
+    unsigned long long* bitmap;  // rows * wordsPerRow words
+    int* wordRank;               // Set bits before each word
+    int* values;                 // nnz values (plus 8 slack for SIMD)
+} BitmapMatrix;
+
+// Triplet with 64-bit indices for matrices beyond int range
+typedef struct {
+    long long row;
+    long long col;
+    int value;
+} SparseEntry;
+
+// Heap-backed, growable triplet container (entries kept in insertion order)
+typedef struct {
+    long long rows;
+    long long cols;
+    long long count;
+    long long capacity;
+    SparseEntry* entries;
+} SparseMatrix;
+
+// Open-addressing hash table that accumulates (row, col, value) updates
+typedef struct {
+    int rows;
+    int cols;
+    long long count;       // Occupied slots
+    long long capacity;    // Power of two
+    int shift;             // 64 - log2(capacity), for Fibonacci hashing
+    long long* keys;       // row * cols + col, -1 for an empty slot
+    int* values;
+} SparseBuilder;
+
+// Conjugate-gradient settings
+typedef struct {
+    double tolerance;      // Stop when ||r|| / ||b|| falls below this
+    int maxIterations;
+    int useJacobi;         // 1 for Jacobi (diagonal) preconditioning
+} SolverOptions;
+
+// Conjugate-gradient results and timing counters
+typedef struct {
+    int iterations;
+    int converged;
+    double residual;           // Final relative residual
+    double totalSeconds;
+    double spmvSeconds;        // Time inside A*p
+    double vectorSeconds;      // Time inside the fused vector kernels
+    double* iterationSeconds;  // Wall time of each iteration
+    double* iterationResidual; // Relative residual after each iteration
+} SolverStats;
+
+// Convert a row-major dense buffer (row stride in elements) to triplets.
+// Stops and warns instead of writing past capacity (header slot included).
+int denseToTriplets(const int* matrix, int rows, int cols, int stride,
+                    SparseElement sparse[], int capacity) {
+    int k = 0; // Index for sparse array
+    
+    // Store matrix dimensions in first element
+    sparse[0].row = rows;
+    sparse[0].col = cols;
+    sparse[0].value = 0; // Will store count of non-zero elements
+    
+    k = 1;
+    
+    // Traverse the matrix and store non-zero elements
+    for (int i = 0; i < rows; i++) {
+        const int* rowData = matrix + (long long)i * stride;
+        for (int j = 0; j < cols; j++) {
+            if (rowData[j] != 0) {
+                if (k >= capacity) {
+                    printf("Sparse array full (%d terms)! Remaining elements dropped.\n", capacity);
+                    sparse[0].value = k - 1;
+                    return k;
+                }
+                sparse[k].row = i;
+                sparse[k].col = j;
+                sparse[k].value = rowData[j];
+                k++;
+            }
+        }
+    }
+    
+    // Store the count of non-zero elements
+    sparse[0].value = k - 1;
+    
+    return k; // Return total elements (including header)
+}
+
+// Function to convert regular matrix to sparse matrix
+int convertToSparse(int matrix[][10], int rows, int cols, SparseElement sparse[]) {
+    return denseToTriplets(&matrix[0][0], rows, cols, 10, sparse, MAX_TERMS);
+}
+
+// Create an empty growable sparse matrix
+SparseMatrix* createSparseMatrix(long long rows, long long cols, long long initialCapacity) {
+    SparseMatrix* m = (SparseMatrix*)malloc(sizeof(SparseMatrix));
+    if (m == NULL) return NULL;
+    
+    if (initialCapacity < 16) initialCapacity = 16;
+    m->rows = rows;
+    m->cols = cols;
+    m->count = 0;
+    m->capacity = initialCapacity;
+    m->entries = (SparseEntry*)malloc(initialCapacity * sizeof(SparseEntry));
+    if (m->entries == NULL) {
+        free(m);
+        return NULL;
+    }
+    return m;
+}
+
+// Free a growable sparse matrix
+void freeSparseMatrix(SparseMatrix* m) {
+    if (m == NULL) return;
+    free(m->entries);
+    free(m);
+}
+
+// Make room for at least 'needed' entries. Returns 1 on success, 0 on failure.
+int reserveSparseMatrix(SparseMatrix* m, long long needed) {
+    if (needed <= m->capacity) return 1;
+    
+    long long newCapacity = m->capacity * 2;
+    if (newCapacity < needed) newCapacity = needed;
+    
+    SparseEntry* grown = (SparseEntry*)realloc(m->entries, newCapacity * sizeof(SparseEntry));
+    if (grown == NULL) {
+        printf("Out of memory growing sparse matrix to %lld entries!\n", newCapacity);
+        return 0;
+    }
+    m->entries = grown;
+    m->capacity = newCapacity;
+    return 1;
+}
+
+// Append one entry, growing the buffer geometrically. Returns 1 on success.
+int appendEntry(SparseMatrix* m, long long row, long long col, int value) {
+    if (row < 0 || row >= m->rows || col < 0 || col >= m->cols) {
+        printf("Entry (%lld, %lld) outside %lldx%lld matrix!\n", row, col, m->rows, m->cols);
+        return 0;
+    }
+    if (m->count == m->capacity && !reserveSparseMatrix(m, m->count + 1)) {
+        return 0;
+    }
+    m->entries[m->count].row = row;
+    m->entries[m->count].col = col;
+    m->entries[m->count].value = value;
+    m->count++;
+    return 1;
+}
+
+// Streaming converter: append the non-zeros of a block of dense rows.
+// 'block' holds numRows rows of m->cols values, 'stride' elements apart,
+// and its first row is matrix row 'firstRow'. Returns non-zeros appended or -1.
+long long appendDenseRows(SparseMatrix* m, const int* block, long long firstRow,
+                          long long numRows, long long stride) {
+    long long added = 0;
+    
+    for (long long i = 0; i < numRows; i++) {
+        const int* rowData = block + i * stride;
+        for (long long j = 0; j < m->cols; j++) {
+            if (rowData[j] != 0) {
+                if (!appendEntry(m, firstRow + i, j, rowData[j])) {
+                    return -1;
+                }
+                added++;
+            }
+        }
+    }
+    return added;
+}
+
+// Convert an arbitrary row-major dense buffer to a growable sparse matrix
+SparseMatrix* convertDenseToSparse(const int* matrix, long long rows, long long cols, long long stride) {
+    SparseMatrix* m = createSparseMatrix(rows, cols, 0);
+    if (m == NULL) return NULL;
+    
+    if (appendDenseRows(m, matrix, 0, rows, stride) < 0) {
+        freeSparseMatrix(m);
+        return NULL;
+    }
+    return m;
+}
+
+// Compare two growable matrices entry by entry (padding ignored)
+int sameSparseMatrix(SparseMatrix* a, SparseMatrix* b) {
+    if (a->rows != b->rows || a->cols != b->cols || a->count != b->count) return 0;
+    for (long long i = 0; i < a->count; i++) {
+        if (a->entries[i].row != b->entries[i].row || a->entries[i].col != b->entries[i].col ||
+            a->entries[i].value != b->entries[i].value) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Number of online CPUs (at least 1)
+int onlineCpus() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+// Run worker on each of count argument records (argSize bytes apart).
+// Record 0 runs on the calling thread; if a thread cannot be started its
+// record also runs inline, so every record is processed exactly once.
+void runParallel(void* (*worker)(void*), void* args, size_t argSize, int count) {
+    pthread_t threads[MAX_THREADS];
+    int started[MAX_THREADS];
+    char* base = (char*)args;
+    
+    for (int t = 1; t < count; t++) {
+        started[t] = pthread_create(&threads[t], NULL, worker, base + t * argSize) == 0;
+        if (!started[t]) worker(base + t * argSize);
+    }
+    if (count > 0) worker(base);
+    for (int t = 1; t < count; t++) {
+        if (started[t]) pthread_join(threads[t], NULL);
+    }
+}
+
+// One block of dense rows handled by one conversion thread
+typedef struct {
+    const int* matrix;
+    long long cols;
+    long long stride;
+    long long firstRow;
+    long long lastRow;      // Exclusive
+    long long* rowStart;    // Per-row output offsets (rows + 1 entries)
+    SparseEntry* out;       // NULL during the counting pass
+} DenseBlock;
+
+// Pass 1 counts non-zeros per row; pass 2 fills this block's slice
+void* convertDenseBlock(void* arg) {
+    DenseBlock* b = (DenseBlock*)arg;
+    
+    for (long long i = b->firstRow; i < b->lastRow; i++) {
+        const int* rowData = b->matrix + i * b->stride;
+        
+        if (b->out == NULL) {
+            long long count = 0;
+            for (long long j = 0; j < b->cols; j++) {
+                count += rowData[j] != 0;
+            }
+            b->rowStart[i + 1] = count;
+        } else {
+            SparseEntry* e = b->out + b->rowStart[i];
+            for (long long j = 0; j < b->cols; j++) {
+                if (rowData[j] != 0) {
+                    e->row = i;
+                    e->col = j;
+                    e->value = rowData[j];
+                    e++;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+// Two-pass parallel version of convertDenseToSparse. Threads count
+// non-zeros per row of their block, a prefix sum over the rows assigns
+// every row its output offset, then threads fill their slices without
+// synchronization. The result is identical to the serial converter.
+SparseMatrix* convertDenseToSparseParallel(const int* matrix, long long rows, long long cols,
+                                           long long stride, int numThreads) {
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAX_THREADS) numThreads = MAX_THREADS;
+    if (numThreads > rows) numThreads = rows > 0 ? (int)rows : 1;
+    
+    long long* rowStart = (long long*)calloc(rows + 1, sizeof(long long));
+    if (rowStart == NULL) return NULL;
+    
+    DenseBlock blocks[MAX_THREADS];
+    for (int t = 0; t < numThreads; t++) {
+        blocks[t].matrix = matrix;
+        blocks[t].cols = cols;
+        blocks[t].stride = stride;
+        blocks[t].firstRow = rows * t / numThreads;
+        blocks[t].lastRow = rows * (t + 1) / numThreads;
+        blocks[t].rowStart = rowStart;
+        blocks[t].out = NULL;
+    }
+    
+    // Pass 1: per-row counts, then prefix sum into row offsets
+    runParallel(convertDenseBlock, blocks, sizeof(DenseBlock), numThreads);
+    for (long long i = 0; i < rows; i++) {
+        rowStart[i + 1] += rowStart[i];
+    }
+    
+    SparseMatrix* m = createSparseMatrix(rows, cols, rowStart[rows]);
+    if (m == NULL) {
+        free(rowStart);
+        return NULL;
+    }
+    
+    // Pass 2: each thread writes only its own rows' slices
+    for (int t = 0; t < numThreads; t++) {
+        blocks[t].out = m->entries;
+    }
+    runParallel(convertDenseBlock, blocks, sizeof(DenseBlock), numThreads);
+    m->count = rowStart[rows];
+    
+    free(rowStart);
+    return m;
+}
+
+// Copy a growable matrix into a triplet array with header row.
+// Returns total elements (including header) or -1 if it does not fit in int.
+int sparseMatrixToTriplets(SparseMatrix* m, SparseElement sparse[], int capacity) {
+    if (m->rows > 2147483647LL || m->cols > 2147483647LL || m->count + 1 > capacity) {
+        printf("Matrix does not fit the int triplet format!\n");
+        return -1;
+    }
+    
+    sparse[0].row = (int)m->rows;
+    sparse[0].col = (int)m->cols;
+    sparse[0].value = (int)m->count;
+    for (long long i = 0; i < m->count; i++) {
+        sparse[i + 1].row = (int)m->entries[i].row;
+        sparse[i + 1].col = (int)m->entries[i].col;
+        sparse[i + 1].value = m->entries[i].value;
+    }
+    return (int)m->count + 1;
+}
+
+// Expand a growable matrix into a row-major dense buffer
+void sparseMatrixToDense(SparseMatrix* m, int* dense, long long stride) {
+    for (long long i = 0; i < m->rows; i++) {
+        memset(dense + i * stride, 0, m->cols * sizeof(int));
+    }
+    for (long long k = 0; k < m->count; k++) {
+        dense[m->entries[k].row * stride + m->entries[k].col] = m->entries[k].value;
+    }
+}
+
+// Display a growable sparse matrix
+void displaySparseMatrix(SparseMatrix* m) {
+    printf("\nSparse Matrix Representation:\n");
+    printf("-----------------------------\n");
+    printf(" Row | Column | Value\n");
+    printf("-----|--------|------\n");
+    printf("%4lld | %6lld | %5lld  <- (rows, cols, count)\n", m->rows, m->cols, m->count);
+    printf("-----|--------|------\n");
+    for (long long i = 0; i < m->count; i++) {
+        printf("%4lld | %6lld | %5d\n", m->entries[i].row, m->entries[i].col, m->entries[i].value);
+    }
+}
+
+// Function to display a row-major dense buffer
+void displayDense(const int* matrix, int rows, int cols, int stride) {
+    printf("\nOriginal Matrix (%dx%d):\n", rows, cols);
+    printf("------------------------\n");
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            printf("%4d ", matrix[(long long)i * stride + j]);
+        }
+        printf("\n");
+    }
+}
+
+// Function to display regular matrix
+void displayMatrix(int matrix[][10], int rows, int cols) {
+    displayDense(&matrix[0][0], rows, cols, 10);
+}
+
+// Function to display sparse matrix
+void displaySparse(SparseElement sparse[], int size) {
+    printf("\nSparse Matrix Representation:\n");
+    printf("-----------------------------\n");
+    printf(" Row | Column | Value\n");
+    printf("-----|--------|------\n");
+    
+    // First row contains dimensions and count
+    printf("%4d | %6d | %5d  <- (rows, cols, count)\n", 
+           sparse[0].row, sparse[0].col, sparse[0].value);
+    printf("-----|--------|------\n");
+    
+    // Print non-zero elements
+    for (int i = 1; i < size; i++) {
+        printf("%4d | %6d | %5d\n", 
+               sparse[i].row, sparse[i].col, sparse[i].value);
+    }
+}
+
+// Byte cost of the triplet layout (header row included)
+long long tripletBytes(long long nonZeroCount) {
+    return (long long)(nonZeroCount + 1) * sizeof(SparseElement);
+}
+
+// Byte cost of a bitmap layout: bitmap words, their ranks and packed values
+long long bitmapBytes(long long rows, long long cols, long long nonZeroCount) {
+    long long words = rows * ((cols + 63) / 64);
+    return words * (long long)(sizeof(unsigned long long) + sizeof(int)) + nonZeroCount * (long long)sizeof(int);
+}
+
+// Byte cost of a compressed layout with the given number of pointer slots
+long long compressedBytes(long long outerDim, long long nonZeroCount) {
+    return (outerDim + 1) * (long long)sizeof(int) + nonZeroCount * 2 * (long long)sizeof(int);
+}
+
+// Function to calculate space savings
+void calculateSavings(long long rows, long long cols, long long nonZeroCount) {
+    long long originalSize = rows * cols * (long long)sizeof(int);
+    long long sparseSize = tripletBytes(nonZeroCount);
+    long long csrSize = compressedBytes(rows, nonZeroCount);
+    long long cscSize = compressedBytes(cols, nonZeroCount);
+    long long bitmapSize = bitmapBytes(rows, cols, nonZeroCount);
+    float savingsPercent = ((float)(originalSize - sparseSize) / originalSize) * 100;
+    
+    printf("\n=== Memory Analysis ===\n");
+    printf("Original matrix size: %lld elements × %lu bytes = %lld bytes\n", 
+           rows * cols, sizeof(int), originalSize);
+    printf("Sparse matrix size: %lld elements × %lu bytes = %lld bytes\n", 
+           nonZeroCount + 1, sizeof(SparseElement), sparseSize);
+    printf("Space savings: %.2f%%\n", savingsPercent);
+    printf("Compression ratio: %.2fx\n", (float)originalSize / sparseSize);
+    
+    printf("\n%-10s %12s %14s %10s\n", "Layout", "Bytes", "Bytes/nonzero", "vs Dense");
+    printf("------------------------------------------------\n");
+    printf("%-10s %12lld %14s %9.2fx\n", "Dense", originalSize, "-", 1.0);
+    printf("%-10s %12lld %14.2f %9.2fx\n", "Triplet", sparseSize,
+           nonZeroCount > 0 ? (double)sparseSize / nonZeroCount : 0.0,
+           (double)originalSize / sparseSize);
+    printf("%-10s %12lld %14.2f %9.2fx\n", "CSR", csrSize,
+           nonZeroCount > 0 ? (double)csrSize / nonZeroCount : 0.0,
+           (double)originalSize / csrSize);
+    printf("%-10s %12lld %14.2f %9.2fx\n", "CSC", cscSize,
+           nonZeroCount > 0 ? (double)cscSize / nonZeroCount : 0.0,
+           (double)originalSize / cscSize);
+    printf("%-10s %12lld %14.2f %9.2fx\n", "Bitmap", bitmapSize,
+           nonZeroCount > 0 ? (double)bitmapSize / nonZeroCount : 0.0,
+           (double)originalSize / bitmapSize);
+}
+
+// Create an empty compressed matrix with room for nnz values
+CompressedMatrix* createCompressed(int rows, int cols, int nnz, int isColumnMajor) {
+    CompressedMatrix* m = (CompressedMatrix*)malloc(sizeof(CompressedMatrix));
+    int outer = isColumnMajor ? cols : rows;
+    
+    m->rows = rows;
+    m->cols = cols;
+    m->nnz = nnz;
+    m->isColumnMajor = isColumnMajor;
+    m->ptr = (int*)calloc(outer + 1, sizeof(int));
+    m->idx = (int*)malloc((nnz > 0 ? nnz : 1) * sizeof(int));
+    m->values = (int*)malloc((nnz > 0 ? nnz : 1) * sizeof(int));
+    return m;
+}
+
+// Free a compressed matrix
+void freeCompressed(CompressedMatrix* m) {
+    if (m == NULL) return;
+    free(m->ptr);
+    free(m->idx);
+    free(m->values);
+    free(m);
+}
+
+// Convert triplet form to CSR/CSC using a counting sort on the outer index.
+// The sort is stable, so row-major triplets give sorted inner indices.
+CompressedMatrix* sparseToCompressed(SparseElement sparse[], int size, int isColumnMajor) {
+    int rows = sparse[0].row;
+    int cols = sparse[0].col;
+    int nnz = size - 1;
+    CompressedMatrix* m = createCompressed(rows, cols, nnz, isColumnMajor);
+    int outer = isColumnMajor ? cols : rows;
+    
+    // Count entries per row (or column)
+    for (int i = 1; i < size; i++) {
+        int key = isColumnMajor ? sparse[i].col : sparse[i].row;
+        m->ptr[key + 1]++;
+    }
+    
+    // Prefix sum gives the start offset of each row (or column)
+    for (int i = 0; i < outer; i++) {
+        m->ptr[i + 1] += m->ptr[i];
+    }
+    
+    // Scatter values, using a moving cursor per row (or column)
+    int* next = (int*)malloc((outer > 0 ? outer : 1) * sizeof(int));
+    for (int i = 0; i < outer; i++) {
+        next[i] = m->ptr[i];
+    }
+    for (int i = 1; i < size; i++) {
+        int key = isColumnMajor ? sparse[i].col : sparse[i].row;
+        int pos = next[key]++;
+        m->idx[pos] = isColumnMajor ? sparse[i].row : sparse[i].col;
+        m->values[pos] = sparse[i].value;
+    }
+    free(next);
+    
+    return m;
+}
+
+// Convert a growable matrix to CSR/CSC (dimensions and count must fit in int)
+CompressedMatrix* sparseMatrixToCompressed(SparseMatrix* m, int isColumnMajor) {
+    if (m->rows > 2147483647LL || m->cols > 2147483647LL || m->count > 2147483647LL) {
+        printf("Matrix too large for int-indexed compressed format!\n");
+        return NULL;
+    }
+    
+    CompressedMatrix* c = createCompressed((int)m->rows, (int)m->cols, (int)m->count, isColumnMajor);
+    int outer = isColumnMajor ? c->cols : c->rows;
+    
+    for (long long i = 0; i < m->count; i++) {
+        long long key = isColumnMajor ? m->entries[i].col : m->entries[i].row;
+        c->ptr[key + 1]++;
+    }
+    for (int i = 0; i < outer; i++) {
+        c->ptr[i + 1] += c->ptr[i];
+    }
+    
+    int* next = (int*)malloc((outer > 0 ? outer : 1) * sizeof(int));
+    for (int i = 0; i < outer; i++) {
+        next[i] = c->ptr[i];
+    }
+    for (long long i = 0; i < m->count; i++) {
+        SparseEntry* e = &m->entries[i];
+        int pos = next[isColumnMajor ? e->col : e->row]++;
+        c->idx[pos] = (int)(isColumnMajor ? e->row : e->col);
+        c->values[pos] = e->value;
+    }
+    free(next);
+    
+    return c;
+}
+
+// Convert CSR/CSC back to row-major triplet form.
+// Returns total elements (including header), like convertToSparse.
+int compressedToSparse(CompressedMatrix* m, SparseElement sparse[]) {
+    sparse[0].row = m->rows;
+    sparse[0].col = m->cols;
+    sparse[0].value = m->nnz;
+    
+    if (!m->isColumnMajor) {
+        // CSR is already row-major, just expand the row pointers
+        int k = 1;
+        for (int i = 0; i < m->rows; i++) {
+            for (int p = m->ptr[i]; p < m->ptr[i + 1]; p++) {
+                sparse[k].row = i;
+                sparse[k].col = m->idx[p];
+                sparse[k].value = m->values[p];
+                k++;
+            }
+        }
+        return k;
+    }
+    
+    // CSC: count entries per row, then scatter column by column so
+    // each row comes out with ascending column indices
+    int* next = (int*)calloc(m->rows + 1, sizeof(int));
+    for (int p = 0; p < m->nnz; p++) {
+        next[m->idx[p] + 1]++;
+    }
+    next[0] = 1; // Skip the header slot
+    for (int i = 0; i < m->rows; i++) {
+        next[i + 1] += next[i];
+    }
+    for (int j = 0; j < m->cols; j++) {
+        for (int p = m->ptr[j]; p < m->ptr[j + 1]; p++) {
+            int k = next[m->idx[p]]++;
+            sparse[k].row = m->idx[p];
+            sparse[k].col = j;
+            sparse[k].value = m->values[p];
+        }
+    }
+    free(next);
+    
+    return m->nnz + 1;
+}
+
+// Expand CSR/CSC into a row-major dense buffer
+void compressedToDense(CompressedMatrix* m, int* dense, long long stride) {
+    for (long long i = 0; i < m->rows; i++) {
+        memset(dense + i * stride, 0, m->cols * sizeof(int));
+    }
+    int outer = m->isColumnMajor ? m->cols : m->rows;
+    for (int o = 0; o < outer; o++) {
+        for (int p = m->ptr[o]; p < m->ptr[o + 1]; p++) {
+            long long row = m->isColumnMajor ? m->idx[p] : o;
+            long long col = m->isColumnMajor ? o : m->idx[p];
+            dense[row * stride + col] = m->values[p];
+        }
+    }
+}
+
+// Transpose CSR (or CSC) arrays with a counting sort on the inner index.
+// The result has the same orientation flag and swapped dimensions.
+CompressedMatrix* transposeCompressed(CompressedMatrix* m) {
+    int outer = m->isColumnMajor ? m->cols : m->rows;
+    int inner = m->isColumnMajor ? m->rows : m->cols;
+    CompressedMatrix* t = createCompressed(m->cols, m->rows, m->nnz, m->isColumnMajor);
+    
+    for (int p = 0; p < m->nnz; p++) {
+        t->ptr[m->idx[p] + 1]++;
+    }
+    for (int i = 0; i < inner; i++) {
+        t->ptr[i + 1] += t->ptr[i];
+    }
+    
+    int* next = (int*)malloc((inner > 0 ? inner : 1) * sizeof(int));
+    memcpy(next, t->ptr, (inner > 0 ? inner : 1) * sizeof(int));
+    for (int o = 0; o < outer; o++) {
+        for (int p = m->ptr[o]; p < m->ptr[o + 1]; p++) {
+            int pos = next[m->idx[p]]++;
+            t->idx[pos] = o;
+            t->values[pos] = m->values[p];
+        }
+    }
+    free(next);
+    
+    return t;
+}
+
+// Function to display compressed matrix arrays
+void displayCompressed(CompressedMatrix* m) {
+    const char* name = m->isColumnMajor ? "CSC" : "CSR";
+    int outer = m->isColumnMajor ? m->cols : m->rows;
+    
+    printf("\n%s Representation (%dx%d, %d non-zero):\n", name, m->rows, m->cols, m->nnz);
+    printf("-----------------------------\n");
+    printf("%s ptr:  ", m->isColumnMajor ? "Col" : "Row");
+    for (int i = 0; i <= outer; i++) {
+        printf("%4d ", m->ptr[i]);
+    }
+    printf("\n%s idx:  ", m->isColumnMajor ? "Row" : "Col");
+    for (int p = 0; p < m->nnz; p++) {
+        printf("%4d ", m->idx[p]);
+    }
+    printf("\nValues:   ");
+    for (int p = 0; p < m->nnz; p++) {
+        printf("%4d ", m->values[p]);
+    }
+    printf("\n");
+}
+
+// Function to reconstruct original matrix from sparse representation
+void reconstructMatrix(SparseElement sparse[], int size, int result[][10]) {
+    int rows = sparse[0].row;
+    int cols = sparse[0].col;
+    
+    // Initialize result matrix with zeros
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            result[i][j] = 0;
+        }
+    }
+    
+    // Fill in non-zero values
+    for (int i = 1; i < size; i++) {
+        result[sparse[i].row][sparse[i].col] = sparse[i].value;
+    }
+}
+
+// Fast transpose using a counting sort on the column index.
+// Row-major input gives row-major output. Returns size (including header).
+int fastTranspose(SparseElement sparse[], int size, SparseElement result[]) {
+    int cols = sparse[0].col;
+    int* startPos = (int*)calloc(cols + 1, sizeof(int));
+    
+    result[0].row = sparse[0].col;
+    result[0].col = sparse[0].row;
+    result[0].value = sparse[0].value;
+    
+    // Count terms per column, then turn counts into starting positions
+    for (int i = 1; i < size; i++) {
+        startPos[sparse[i].col + 1]++;
+    }
+    startPos[0] = 1; // Skip the header slot
+    for (int j = 0; j < cols; j++) {
+        startPos[j + 1] += startPos[j];
+    }
+    
+    for (int i = 1; i < size; i++) {
+        int k = startPos[sparse[i].col]++;
+        result[k].row = sparse[i].col;
+        result[k].col = sparse[i].row;
+        result[k].value = sparse[i].value;
+    }
+    
+    free(startPos);
+    return size;
+}
+
+// Compare two column indices for qsort
+int compareInt(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Compare two doubles for qsort
+int compareDouble(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Sparse-times-sparse multiply (Gustavson) with a dense row accumulator.
+// Each row of A scales rows of B into the accumulator; touched columns are
+// tracked so resetting costs O(row nonzeros), not O(cols). Products that
+// cancel to zero are dropped. Sums are kept in long long; a result entry
+// outside the int range is an error. Returns size (including header) or -1.
+int multiplySparse(SparseElement a[], int sizeA, SparseElement b[], int sizeB,
+                   SparseElement result[], int capacity) {
+    if (a[0].col != b[0].row) {
+        printf("Dimension mismatch: %dx%d * %dx%d!\n", a[0].row, a[0].col, b[0].row, b[0].col);
+        return -1;
+    }
+    
+    int rows = a[0].row;
+    int cols = b[0].col;
+    CompressedMatrix* csrA = sparseToCompressed(a, sizeA, 0);
+    CompressedMatrix* csrB = sparseToCompressed(b, sizeB, 0);
+    long long* acc = (long long*)calloc(cols > 0 ? cols : 1, sizeof(long long));
+    int* marker = (int*)malloc((cols > 0 ? cols : 1) * sizeof(int));
+    int* touched = (int*)malloc((cols > 0 ? cols : 1) * sizeof(int));
+    int k = 1;
+    
+    for (int j = 0; j < cols; j++) {
+        marker[j] = -1;
+    }
+    
+    result[0].row = rows;
+    result[0].col = cols;
+    
+    for (int i = 0; i < rows && k >= 0; i++) {
+        int numTouched = 0;
+        
+        for (int p = csrA->ptr[i]; p < csrA->ptr[i + 1]; p++) {
+            int inner = csrA->idx[p];
+            long long av = csrA->values[p];
+            for (int q = csrB->ptr[inner]; q < csrB->ptr[inner + 1]; q++) {
+                int j = csrB->idx[q];
+                if (marker[j] != i) {
+                    marker[j] = i;
+                    acc[j] = 0;
+                    touched[numTouched++] = j;
+                }
+                acc[j] += av * csrB->values[q];
+            }
+        }
+        
+        // Emit in column order to keep the result row-major
+        qsort(touched, numTouched, sizeof(int), compareInt);
+        for (int t = 0; t < numTouched; t++) {
+            int j = touched[t];
+            if (acc[j] == 0) continue;
+            if (k >= capacity) {
+                printf("Result exceeds %d terms!\n", capacity);
+                k = -1;
+                break;
+            }
+            if (acc[j] < -2147483647LL - 1 || acc[j] > 2147483647LL) {
+                printf("Product entry (%d, %d) = %lld does not fit in an int!\n", i, j, acc[j]);
+                k = -1;
+                break;
+            }
+            result[k].row = i;
+            result[k].col = j;
+            result[k].value = (int)acc[j];
+            k++;
+        }
+    }
+    
+    if (k > 0) result[0].value = k - 1;
+    
+    free(acc);
+    free(marker);
+    free(touched);
+    freeCompressed(csrA);
+    freeCompressed(csrB);
+    return k;
+}
+
+// Check whether triplets are in strict row-major order
+int isRowMajorSorted(SparseElement sparse[], int size) {
+    for (int i = 2; i < size; i++) {
+        if (sparse[i].row < sparse[i - 1].row ||
+            (sparse[i].row == sparse[i - 1].row && sparse[i].col <= sparse[i - 1].col)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Stable counting-sort pass on row (byRow = 1) or column (byRow = 0)
+void countingPass(SparseElement from[], SparseElement to[], int count, int buckets, int byRow) {
+    int* start = (int*)calloc(buckets + 1, sizeof(int));
+    
+    for (int i = 0; i < count; i++) {
+        start[(byRow ? from[i].row : from[i].col) + 1]++;
+    }
+    for (int b = 0; b < buckets; b++) {
+        start[b + 1] += start[b];
+    }
+    for (int i = 0; i < count; i++) {
+        to[start[byRow ? from[i].row : from[i].col]++] = from[i];
+    }
+    
+    free(start);
+}
+
+// LSD radix sort of the terms into row-major order: a stable pass on the
+// column followed by a stable pass on the row, O(count + rows + cols).
+void radixSortSparse(SparseElement sparse[], int size) {
+    int count = size - 1;
+    if (count < 2) return;
+    
+    SparseElement* temp = (SparseElement*)malloc(count * sizeof(SparseElement));
+    countingPass(sparse + 1, temp, count, sparse[0].col, 0);
+    countingPass(temp, sparse + 1, count, sparse[0].row, 1);
+    free(temp);
+}
+
+// Return sparse itself if row-major, otherwise a sorted heap copy
+SparseElement* sortedView(SparseElement sparse[], int size) {
+    if (isRowMajorSorted(sparse, size)) return sparse;
+    
+    SparseElement* copy = (SparseElement*)malloc(size * sizeof(SparseElement));
+    memcpy(copy, sparse, size * sizeof(SparseElement));
+    radixSortSparse(copy, size);
+    return copy;
+}
+
+// Element-wise add, subtract or Hadamard product by a single linear merge
+// of row-major terms. Unsorted inputs are radix-sorted into a copy first;
+// each input is assumed to hold every coordinate at most once. Results that
+// come out zero are dropped. Returns size (including header) or -1.
+int mergeSparse(SparseElement a[], int sizeA, SparseElement b[], int sizeB,
+                SparseElement result[], int capacity, int op) {
+    if (a[0].row != b[0].row || a[0].col != b[0].col) {
+        printf("Dimension mismatch: %dx%d vs %dx%d!\n", a[0].row, a[0].col, b[0].row, b[0].col);
+        return -1;
+    }
+    
+    SparseElement* sa = sortedView(a, sizeA);
+    SparseElement* sb = sortedView(b, sizeB);
+    int i = 1, j = 1, k = 1;
+    
+    result[0].row = a[0].row;
+    result[0].col = a[0].col;
+    
+    while (i < sizeA || j < sizeB) {
+        int row, col, value;
+        
+        // Compare (row, col) keys; exhausted inputs sort last
+        int cmp;
+        if (i >= sizeA) cmp = 1;
+        else if (j >= sizeB) cmp = -1;
+        else if (sa[i].row != sb[j].row) cmp = sa[i].row < sb[j].row ? -1 : 1;
+        else cmp = (sa[i].col > sb[j].col) - (sa[i].col < sb[j].col);
+        
+        if (cmp < 0) {
+            row = sa[i].row;
+            col = sa[i].col;
+            value = op == SPARSE_HADAMARD ? 0 : sa[i].value;
+            i++;
+        } else if (cmp > 0) {
+            row = sb[j].row;
+            col = sb[j].col;
+            value = op == SPARSE_HADAMARD ? 0 : (op == SPARSE_SUBTRACT ? -sb[j].value : sb[j].value);
+            j++;
+        } else {
+            row = sa[i].row;
+            col = sa[i].col;
+            if (op == SPARSE_ADD) value = sa[i].value + sb[j].value;
+            else if (op == SPARSE_SUBTRACT) value = sa[i].value - sb[j].value;
+            else value = sa[i].value * sb[j].value;
+            i++;
+            j++;
+        }
+        
+        if (value == 0) continue;
+        if (k >= capacity) {
+            printf("Result exceeds %d terms!\n", capacity);
+            k = -1;
+            break;
+        }
+        result[k].row = row;
+        result[k].col = col;
+        result[k].value = value;
+        k++;
+    }
+    
+    if (k > 0) result[0].value = k - 1;
+    if (sa != a) free(sa);
+    if (sb != b) free(sb);
+    return k;
+}
+
+// Element-wise A + B
+int addSparse(SparseElement a[], int sizeA, SparseElement b[], int sizeB,
+              SparseElement result[], int capacity) {
+    return mergeSparse(a, sizeA, b, sizeB, result, capacity, SPARSE_ADD);
+}
+
+// Element-wise A - B
+int subtractSparse(SparseElement a[], int sizeA, SparseElement b[], int sizeB,
+                   SparseElement result[], int capacity) {
+    return mergeSparse(a, sizeA, b, sizeB, result, capacity, SPARSE_SUBTRACT);
+}
+
+// Element-wise (Hadamard) product A .* B
+int hadamardSparse(SparseElement a[], int sizeA, SparseElement b[], int sizeB,
+                   SparseElement result[], int capacity) {
+    return mergeSparse(a, sizeA, b, sizeB, result, capacity, SPARSE_HADAMARD);
+}
+
+// Allocate builder slots for the given power-of-two capacity
+int allocBuilderSlots(SparseBuilder* b, long long capacity) {
+    b->keys = (long long*)malloc(capacity * sizeof(long long));
+    b->values = (int*)malloc(capacity * sizeof(int));
+    if (b->keys == NULL || b->values == NULL) {
+        free(b->keys);
+        free(b->values);
+        return 0;
+    }
+    
+    for (long long i = 0; i < capacity; i++) {
+        b->keys[i] = -1;
+    }
+    b->capacity = capacity;
+    b->shift = 64;
+    while (capacity > 1) {
+        capacity >>= 1;
+        b->shift--;
+    }
+    return 1;
+}
+
+// Create a builder sized for about expectedEntries distinct coordinates
+SparseBuilder* createBuilder(int rows, int cols, long long expectedEntries) {
+    SparseBuilder* b = (SparseBuilder*)malloc(sizeof(SparseBuilder));
+    long long capacity = 16;
+    while (capacity < expectedEntries * 2) {
+        capacity *= 2;
+    }
+    
+    b->rows = rows;
+    b->cols = cols;
+    b->count = 0;
+    if (!allocBuilderSlots(b, capacity)) {
+        free(b);
+        return NULL;
+    }
+    return b;
+}
+
+// Free a builder
+void freeBuilder(SparseBuilder* b) {
+    if (b == NULL) return;
+    free(b->keys);
+    free(b->values);
+    free(b);
+}
+
+// Slot holding key, or the empty slot where it belongs (linear probing)
+long long builderSlot(SparseBuilder* b, long long key) {
+    long long mask = b->capacity - 1;
+    long long slot = (long long)(((unsigned long long)key * 0x9E3779B97F4A7C15ULL) >> b->shift);
+    
+    while (b->keys[slot] != -1 && b->keys[slot] != key) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Double the table, rehashing every occupied slot
+int growBuilder(SparseBuilder* b) {
+    long long oldCapacity = b->capacity;
+    long long* oldKeys = b->keys;
+    int* oldValues = b->values;
+    
+    if (!allocBuilderSlots(b, oldCapacity * 2)) {
+        b->keys = oldKeys;
+        b->values = oldValues;
+        printf("Out of memory growing sparse builder!\n");
+        return 0;
+    }
+    for (long long i = 0; i < oldCapacity; i++) {
+        if (oldKeys[i] != -1) {
+            long long slot = builderSlot(b, oldKeys[i]);
+            b->keys[slot] = oldKeys[i];
+            b->values[slot] = oldValues[i];
+        }
+    }
+    
+    free(oldKeys);
+    free(oldValues);
+    return 1;
+}
+
+// Add value at (row, col); repeated coordinates are summed.
+// Returns 1 on success, 0 on a bad coordinate or allocation failure.
+int builderAdd(SparseBuilder* b, int row, int col, int value) {
+    if (row < 0 || row >= b->rows || col < 0 || col >= b->cols) {
+        printf("Entry (%d, %d) outside %dx%d matrix!\n", row, col, b->rows, b->cols);
+        return 0;
+    }
+    
+    // Keep the load factor at or below 0.7
+    if ((b->count + 1) * 10 > b->capacity * 7 && !growBuilder(b)) {
+        return 0;
+    }
+    
+    long long key = (long long)row * b->cols + col;
+    long long slot = builderSlot(b, key);
+    if (b->keys[slot] == -1) {
+        b->keys[slot] = key;
+        b->values[slot] = value;
+        b->count++;
+    } else {
+        b->values[slot] += value;
+    }
+    return 1;
+}
+
+// Write the accumulated entries as row-major triplets with header row.
+// Coordinates that summed to zero are dropped. Needs capacity of at most
+// count + 1. Returns size (including header) or -1.
+int finalizeBuilder(SparseBuilder* b, SparseElement result[], int capacity) {
+    int k = 1;
+    
+    result[0].row = b->rows;
+    result[0].col = b->cols;
+    
+    // Compact the occupied slots, then order them with the (row, col) radix sort
+    for (long long i = 0; i < b->capacity; i++) {
+        if (b->keys[i] == -1 || b->values[i] == 0) continue;
+        if (k >= capacity) {
+            printf("Result exceeds %d terms!\n", capacity);
+            return -1;
+        }
+        result[k].row = (int)(b->keys[i] / b->cols);
+        result[k].col = (int)(b->keys[i] % b->cols);
+        result[k].value = b->values[i];
+        k++;
+    }
+    result[0].value = k - 1;
+    
+    radixSortSparse(result, k);
+    return k;
+}
+
+// Scalar CSR SpMV inner loop: y[i] = sum of A[i][j] * x[j]
+void spmvScalar(CompressedMatrix* m, const double* x, double* y) {
+    for (int i = 0; i < m->rows; i++) {
+        double sum = 0.0;
+        for (int p = m->ptr[i]; p < m->ptr[i + 1]; p++) {
+            sum += m->values[p] * x[m->idx[p]];
+        }
+        y[i] = sum;
+    }
+}
+
+#ifdef SPMV_X86
+// SSE2 CSR SpMV: two nonzeros per step, x loaded by index
+__attribute__((target("sse2")))
+void spmvSSE2(CompressedMatrix* m, const double* x, double* y) {
+    for (int i = 0; i < m->rows; i++) {
+        int p = m->ptr[i];
+        int end = m->ptr[i + 1];
+        __m128d acc = _mm_setzero_pd();
+        
+        for (; p + 2 <= end; p += 2) {
+            __m128d vals = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*)&m->values[p]));
+            __m128d xs = _mm_set_pd(x[m->idx[p + 1]], x[m->idx[p]]);
+            acc = _mm_add_pd(acc, _mm_mul_pd(vals, xs));
+        }
+        
+        double lanes[2];
+        _mm_storeu_pd(lanes, acc);
+        double sum = lanes[0] + lanes[1];
+        for (; p < end; p++) {
+            sum += m->values[p] * x[m->idx[p]];
+        }
+        y[i] = sum;
+    }
+}
+
+// AVX2 CSR SpMV: four nonzeros per step, x gathered by index
+__attribute__((target("avx2,fma")))
+void spmvAVX2(CompressedMatrix* m, const double* x, double* y) {
+    for (int i = 0; i < m->rows; i++) {
+        int p = m->ptr[i];
+        int end = m->ptr[i + 1];
+        __m256d acc = _mm256_setzero_pd();
+        
+        for (; p + 4 <= end; p += 4) {
+            __m128i cols = _mm_loadu_si128((const __m128i*)&m->idx[p]);
+            __m256d vals = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)&m->values[p]));
+            __m256d xs = _mm256_i32gather_pd(x, cols, 8);
+            acc = _mm256_fmadd_pd(vals, xs, acc);
+        }
+        
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+        double lanes[2];
+        _mm_storeu_pd(lanes, half);
+        double sum = lanes[0] + lanes[1];
+        for (; p < end; p++) {
+            sum += m->values[p] * x[m->idx[p]];
+        }
+        y[i] = sum;
+    }
+}
+#endif
+
+// Pick the fastest kernel this CPU supports. The CPU is probed once and
+// the answer cached, since this is called from inside timed SpMV loops.
+int detectSpmvKernel() {
+    static int kernel = -1;
+    if (kernel >= 0) {
+        return kernel;
+    }
+    kernel = SPMV_SCALAR;
+#ifdef SPMV_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        kernel = SPMV_AVX2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        kernel = SPMV_SSE2;
+    }
+#endif
+    return kernel;
+}
+
+const char* spmvKernelName(int kernel) {
+    switch (kernel) {
+        case SPMV_AVX2:
+            return "AVX2";
+        case SPMV_SSE2:
+            return "SSE2";
+        default:
+            return "Scalar";
+    }
+}
+
+// CSC SpMV: scatter each column into y
+void spmvColumns(CompressedMatrix* m, const double* x, double* y) {
+    for (int i = 0; i < m->rows; i++) {
+        y[i] = 0.0;
+    }
+    for (int j = 0; j < m->cols; j++) {
+        double xj = x[j];
+        for (int p = m->ptr[j]; p < m->ptr[j + 1]; p++) {
+            y[m->idx[p]] += m->values[p] * xj;
+        }
+    }
+}
+
+// Sparse matrix-vector multiply y = A*x with an explicit kernel choice.
+// Kernels not available on this CPU fall back to the scalar loop.
+void spmvWithKernel(CompressedMatrix* m, const double* x, double* y, int kernel) {
+    if (m->isColumnMajor) {
+        spmvColumns(m, x, y);
+        return;
+    }
+#ifdef SPMV_X86
+    if (kernel == SPMV_AVX2 && detectSpmvKernel() == SPMV_AVX2) {
+        spmvAVX2(m, x, y);
+        return;
+    }
+    if (kernel >= SPMV_SSE2 && detectSpmvKernel() >= SPMV_SSE2) {
+        spmvSSE2(m, x, y);
+        return;
+    }
+#endif
+    (void)kernel;
+    spmvScalar(m, x, y);
+}
+
+// Sparse matrix-vector multiply y = A*x using the best kernel for this CPU
+void spmv(CompressedMatrix* m, const double* x, double* y) {
+    spmvWithKernel(m, x, y, detectSpmvKernel());
+}
+
+// Free a block-sparse matrix
+void freeBlock(BlockMatrix* b) {
+    if (b == NULL) return;
+    free(b->blockPtr);
+    free(b->blockCol);
+    free(b->values);
+    free(b);
+}
+
+// Convert CSR to BSR. Each block row is scanned twice: once to find its
+// distinct tile columns (kept sorted), once to scatter values into tiles.
+BlockMatrix* compressedToBlock(CompressedMatrix* m) {
+    if (m->isColumnMajor) {
+        printf("Block conversion expects CSR input!\n");
+        return NULL;
+    }
+    
+    BlockMatrix* b = (BlockMatrix*)malloc(sizeof(BlockMatrix));
+    b->rows = m->rows;
+    b->cols = m->cols;
+    b->blockRows = (m->rows + BSR_BLOCK - 1) / BSR_BLOCK;
+    b->blockCols = (m->cols + BSR_BLOCK - 1) / BSR_BLOCK;
+    b->nnz = m->nnz;
+    b->blockPtr = (int*)calloc(b->blockRows + 1, sizeof(int));
+    
+    int* slot = (int*)malloc((b->blockCols > 0 ? b->blockCols : 1) * sizeof(int));
+    int* touched = (int*)malloc((b->blockCols > 0 ? b->blockCols : 1) * sizeof(int));
+    for (int j = 0; j < b->blockCols; j++) {
+        slot[j] = -1;
+    }
+    
+    // Pass 1: count distinct tiles per block row
+    for (int br = 0; br < b->blockRows; br++) {
+        int numTouched = 0;
+        int lastRow = (br + 1) * BSR_BLOCK < m->rows ? (br + 1) * BSR_BLOCK : m->rows;
+        for (int i = br * BSR_BLOCK; i < lastRow; i++) {
+            for (int p = m->ptr[i]; p < m->ptr[i + 1]; p++) {
+                int bc = m->idx[p] / BSR_BLOCK;
+                if (slot[bc] != br) {
+                    slot[bc] = br;
+                    numTouched++;
+                }
+            }
+        }
+        b->blockPtr[br + 1] = b->blockPtr[br] + numTouched;
+    }
+    
+    b->numBlocks = b->blockPtr[b->blockRows];
+    b->blockCol = (int*)malloc((b->numBlocks > 0 ? b->numBlocks : 1) * sizeof(int));
+    b->values = (double*)calloc((size_t)(b->numBlocks > 0 ? b->numBlocks : 1) * BSR_BLOCK * BSR_BLOCK,
+                                sizeof(double));
+    for (int j = 0; j < b->blockCols; j++) {
+        slot[j] = -1;
+    }
+    
+    // Pass 2: sort each block row's tile columns, then scatter values
+    for (int br = 0; br < b->blockRows; br++) {
+        int numTouched = 0;
+        int lastRow = (br + 1) * BSR_BLOCK < m->rows ? (br + 1) * BSR_BLOCK : m->rows;
+        for (int i = br * BSR_BLOCK; i < lastRow; i++) {
+            for (int p = m->ptr[i]; p < m->ptr[i + 1]; p++) {
+                int bc = m->idx[p] / BSR_BLOCK;
+                if (slot[bc] == -1) {
+                    slot[bc] = 0;
+                    touched[numTouched++] = bc;
+                }
+            }
+        }
+        qsort(touched, numTouched, sizeof(int), compareInt);
+        for (int t = 0; t < numTouched; t++) {
+            b->blockCol[b->blockPtr[br] + t] = touched[t];
+            slot[touched[t]] = b->blockPtr[br] + t;
+        }
+        
+        for (int i = br * BSR_BLOCK; i < lastRow; i++) {
+            for (int p = m->ptr[i]; p < m->ptr[i + 1]; p++) {
+                int tile = slot[m->idx[p] / BSR_BLOCK];
+                double* values = b->values + (size_t)tile * BSR_BLOCK * BSR_BLOCK;
+                values[(m->idx[p] % BSR_BLOCK) * BSR_BLOCK + i % BSR_BLOCK] = m->values[p];
+            }
+        }
+        for (int t = 0; t < numTouched; t++) {
+            slot[touched[t]] = -1;
+        }
+    }
+    
+    free(slot);
+    free(touched);
+    return b;
+}
+
+// Convert triplet form to BSR
+BlockMatrix* sparseToBlock(SparseElement sparse[], int size) {
+    CompressedMatrix* csr = sparseToCompressed(sparse, size, 0);
+    BlockMatrix* b = compressedToBlock(csr);
+    freeCompressed(csr);
+    return b;
+}
+
+// Byte cost of a BSR layout
+long long blockBytes(BlockMatrix* b) {
+    return (long long)(b->blockRows + 1) * sizeof(int) + (long long)b->numBlocks * sizeof(int) +
+           (long long)b->numBlocks * BSR_BLOCK * BSR_BLOCK * sizeof(double);
+}
+
+// Expand BSR into a row-major dense buffer
+void blockToDense(BlockMatrix* b, int* dense, long long stride) {
+    for (long long i = 0; i < b->rows; i++) {
+        memset(dense + i * stride, 0, b->cols * sizeof(int));
+    }
+    for (int br = 0; br < b->blockRows; br++) {
+        for (int t = b->blockPtr[br]; t < b->blockPtr[br + 1]; t++) {
+            const double* tile = b->values + (size_t)t * BSR_BLOCK * BSR_BLOCK;
+            for (int r = 0; r < BSR_BLOCK && br * BSR_BLOCK + r < b->rows; r++) {
+                for (int c = 0; c < BSR_BLOCK && b->blockCol[t] * BSR_BLOCK + c < b->cols; c++) {
+                    dense[(long long)(br * BSR_BLOCK + r) * stride + b->blockCol[t] * BSR_BLOCK + c] =
+                        (int)tile[c * BSR_BLOCK + r];
+                }
+            }
+        }
+    }
+}
+
+// Add one tile's product into acc. Tiles are column-major, so each column
+// is scaled by a single x value; interior tiles use a fixed-size loop the
+// compiler unrolls and vectorizes, tiles on the right edge stop at cols.
+static inline void blockTileProduct(const double* tile, const double* x, int col0, int cols,
+                                    double* acc) {
+    if (col0 + BSR_BLOCK <= cols) {
+        for (int c = 0; c < BSR_BLOCK; c++) {
+            double xc = x[col0 + c];
+            for (int r = 0; r < BSR_BLOCK; r++) {
+                acc[r] += tile[c * BSR_BLOCK + r] * xc;
+            }
+        }
+    } else {
+        for (int c = 0; col0 + c < cols; c++) {
+            for (int r = 0; r < BSR_BLOCK; r++) {
+                acc[r] += tile[c * BSR_BLOCK + r] * x[col0 + c];
+            }
+        }
+    }
+}
+
+#if defined(SPMV_X86) && BSR_BLOCK == 4
+// AVX2 4x4 BSR SpMV: the four row sums of a block row stay in one
+// register, and each tile is four FMAs of a tile column by a broadcast x
+__attribute__((target("avx2,fma")))
+void spmvBlockAVX2(BlockMatrix* b, const double* x, double* y) {
+    for (int br = 0; br < b->blockRows; br++) {
+        __m256d acc = _mm256_setzero_pd();
+        int t = b->blockPtr[br];
+        int end = b->blockPtr[br + 1];
+        
+        // Only the last tile of a block row can cross the right edge
+        if (end > t && b->blockCol[end - 1] * 4 + 4 > b->cols) end--;
+        for (; t < end; t++) {
+            const double* tile = b->values + (size_t)t * 16;
+            const double* xs = x + b->blockCol[t] * 4;
+            acc = _mm256_fmadd_pd(_mm256_loadu_pd(tile), _mm256_broadcast_sd(xs), acc);
+            acc = _mm256_fmadd_pd(_mm256_loadu_pd(tile + 4), _mm256_broadcast_sd(xs + 1), acc);
+            acc = _mm256_fmadd_pd(_mm256_loadu_pd(tile + 8), _mm256_broadcast_sd(xs + 2), acc);
+            acc = _mm256_fmadd_pd(_mm256_loadu_pd(tile + 12), _mm256_broadcast_sd(xs + 3), acc);
+        }
+        
+        double sums[4];
+        _mm256_storeu_pd(sums, acc);
+        for (; t < b->blockPtr[br + 1]; t++) {
+            blockTileProduct(b->values + (size_t)t * 16, x, b->blockCol[t] * 4, b->cols, sums);
+        }
+        for (int r = 0; r < 4 && br * 4 + r < b->rows; r++) {
+            y[br * 4 + r] = sums[r];
+        }
+    }
+}
+#endif
+
+// Block SpMV y = A*x, one accumulator per tile row. Padding rows past the
+// bottom edge are summed but never stored.
+void spmvBlock(BlockMatrix* b, const double* x, double* y) {
+#if defined(SPMV_X86) && BSR_BLOCK == 4
+    if (detectSpmvKernel() == SPMV_AVX2) {
+        spmvBlockAVX2(b, x, y);
+        return;
+    }
+#endif
+    for (int br = 0; br < b->blockRows; br++) {
+        double acc[BSR_BLOCK] = {0};
+        
+        for (int t = b->blockPtr[br]; t < b->blockPtr[br + 1]; t++) {
+            blockTileProduct(b->values + (size_t)t * BSR_BLOCK * BSR_BLOCK, x,
+                             b->blockCol[t] * BSR_BLOCK, b->cols, acc);
+        }
+        
+        int row0 = br * BSR_BLOCK;
+        for (int r = 0; r < BSR_BLOCK && row0 + r < b->rows; r++) {
+            y[row0 + r] = acc[r];
+        }
+    }
+}
+
+// Append the LEB128 varint form of value, returning bytes written
+int encodeVarint(unsigned char* out, unsigned long long value) {
+    int n = 0;
+    while (value >= 0x80) {
+        out[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (unsigned char)value;
+    return n;
+}
+
+// Decode up to max varints from [p, end) into out. Runs of 16 single-byte
+// varints (the common case for dense rows) are found with one SSE2
+// continuation-bit mask and copied without branching; one- and two-byte
+// varints (every gap below 16384) are decoded branch-free from a byte pair.
+// Returns the count decoded, or -1 on a varint longer than 10 bytes;
+// *consumed gets the number of bytes used.
+int decodeVarintBatch(const unsigned char* p, const unsigned char* end,
+                      unsigned long long* out, int max, long long* consumed) {
+    const unsigned char* start = p;
+    int n = 0;
+    
+    while (n < max && p < end) {
+#ifdef SPMV_X86
+        if (end - p >= 16 && max - n >= 16 &&
+            _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)p)) == 0) {
+            for (int i = 0; i < 16; i++) {
+                out[n + i] = p[i];
+            }
+            n += 16;
+            p += 16;
+            continue;
+        }
+#endif
+        // One byte, or two with the second one ending the varint
+        if (end - p >= 2 && (p[0] & p[1] & 0x80) == 0) {
+            unsigned long long two = p[0] >> 7;
+            out[n++] = (p[0] & 0x7Fu) | (((p[1] & 0x7Fu) << 7) & (0 - two));
+            p += 1 + two;
+            continue;
+        }
+        
+        // Slow path: one multi-byte varint
+        unsigned long long value = 0;
+        int shift = 0;
+        while (p < end) {
+            if (shift > 63) return -1;  // Over 10 bytes: corrupt, not a 64-bit value
+            unsigned char byte = *p++;
+            value |= (unsigned long long)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) break;
+            shift += 7;
+        }
+        out[n++] = value;
+    }
+    
+    *consumed = p - start;
+    return n;
+}
+
+// Free an encoded matrix
+void freeEncoded(EncodedMatrix* e) {
+    if (e == NULL) return;
+    free(e->bytes);
+    free(e->values);
+    free(e);
+}
+
+// Encode a CSR matrix whose rows have ascending column indices
+EncodedMatrix* compressedToEncoded(CompressedMatrix* m) {
+    if (m->isColumnMajor) {
+        printf("Encoding expects CSR input!\n");
+        return NULL;
+    }
+    
+    EncodedMatrix* e = (EncodedMatrix*)malloc(sizeof(EncodedMatrix));
+    e->rows = m->rows;
+    e->cols = m->cols;
+    e->count = m->nnz;
+    // A gap below 2^63 never needs more than 10 bytes
+    e->bytes = (unsigned char*)malloc((size_t)(m->nnz > 0 ? m->nnz : 1) * 10);
+    e->values = (int*)malloc((m->nnz > 0 ? m->nnz : 1) * sizeof(int));
+    
+    long long used = 0;
+    long long previous = -1;
+    for (int i = 0; i < m->rows; i++) {
+        for (int p = m->ptr[i]; p < m->ptr[i + 1]; p++) {
+            long long linear = (long long)i * m->cols + m->idx[p];
+            if (linear <= previous) {
+                printf("Row %d is not sorted by column; cannot encode!\n", i);
+                freeEncoded(e);
+                return NULL;
+            }
+            used += encodeVarint(e->bytes + used, (unsigned long long)(linear - previous - 1));
+            e->values[p] = m->values[p];
+            previous = linear;
+        }
+    }
+    
+    // Trim the worst-case allocation to the real size
+    unsigned char* trimmed = (unsigned char*)realloc(e->bytes, used > 0 ? used : 1);
+    if (trimmed != NULL) e->bytes = trimmed;
+    e->numBytes = used;
+    return e;
+}
+
+// Encode row-major triplets
+EncodedMatrix* sparseToEncoded(SparseElement sparse[], int size) {
+    CompressedMatrix* csr = sparseToCompressed(sparse, size, 0);
+    EncodedMatrix* e = compressedToEncoded(csr);
+    freeCompressed(csr);
+    return e;
+}
+
+// Byte cost of an encoded matrix
+long long encodedBytes(EncodedMatrix* e) {
+    return e->numBytes + e->count * (long long)sizeof(int);
+}
+
+// Start an iterator before the first entry
+void initEncodedIterator(EncodedIterator* it, EncodedMatrix* m) {
+    it->m = m;
+    it->offset = 0;
+    it->index = 0;
+    it->row = 0;
+    it->col = -1;
+    it->batchPos = 0;
+    it->batchLen = 0;
+}
+
+// Fetch the next entry. Returns 1 and fills row/col/value, or 0 at the end.
+int nextEncoded(EncodedIterator* it, long long* row, long long* col, int* value) {
+    EncodedMatrix* m = it->m;
+    if (it->index >= m->count) return 0;
+    
+    if (it->batchPos == it->batchLen) {
+        long long consumed;
+        long long left = m->count - it->index;
+        it->batchLen = decodeVarintBatch(m->bytes + it->offset, m->bytes + m->numBytes, it->deltas,
+                                         left < ENCODED_BATCH ? (int)left : ENCODED_BATCH, &consumed);
+        it->batchPos = 0;
+        if (it->batchLen <= 0) {  // Byte stream ran out early or is corrupt
+            it->batchLen = 0;
+            return 0;
+        }
+        it->offset += consumed;
+    }
+    
+    // Advance along the row; divide only when the gap skips whole rows
+    it->col += (long long)it->deltas[it->batchPos++] + 1;
+    if (it->col >= m->cols) {
+        it->col -= m->cols;
+        it->row++;
+        if (it->col >= m->cols) {
+            it->row += it->col / m->cols;
+            it->col %= m->cols;
+        }
+    }
+    
+    *row = it->row;
+    *col = it->col;
+    *value = m->values[it->index++];
+    return 1;
+}
+
+// SpMV y = A*x streamed straight from the encoded form. Same decoding as
+// nextEncoded, inlined so each row's sum stays in a register.
+void spmvEncoded(EncodedMatrix* m, const double* x, double* y) {
+    unsigned long long deltas[ENCODED_BATCH];
+    long long offset = 0;
+    long long index = 0;
+    long long row = 0;
+    long long col = -1;
+    double sum = 0.0;
+    
+    for (long long i = 0; i < m->rows; i++) {
+        y[i] = 0.0;
+    }
+    
+    while (index < m->count) {
+        long long consumed;
+        long long left = m->count - index;
+        int n = decodeVarintBatch(m->bytes + offset, m->bytes + m->numBytes, deltas,
+                                  left < ENCODED_BATCH ? (int)left : ENCODED_BATCH, &consumed);
+        if (n <= 0) break;  // Byte stream ran out early or is corrupt
+        const int* values = m->values + index;
+        offset += consumed;
+        index += n;
+        
+        for (int k = 0; k < n; k++) {
+            col += (long long)deltas[k] + 1;
+            // Total row steps over the whole matrix are bounded by rows
+            while (col >= m->cols) {
+                y[row] += sum;
+                sum = 0.0;
+                row++;
+                col -= m->cols;
+            }
+            sum += values[k] * x[col];
+        }
+    }
+    if (m->count > 0) y[row] += sum;
+}
+
+// Expand an encoded matrix into a row-major dense buffer
+void encodedToDense(EncodedMatrix* m, int* dense, long long stride) {
+    EncodedIterator it;
+    long long row, col;
+    int value;
+    
+    for (long long i = 0; i < m->rows; i++) {
+        memset(dense + i * stride, 0, m->cols * sizeof(int));
+    }
+    initEncodedIterator(&it, m);
+    while (nextEncoded(&it, &row, &col, &value)) {
+        dense[row * stride + col] = value;
+    }
+}
+
+// Save an encoded matrix to disk. Returns 1 on success.
+int saveEncoded(const char* path, EncodedMatrix* e) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        printf("Cannot create %s!\n", path);
+        return 0;
+    }
+    
+    long long header[4] = {e->rows, e->cols, e->count, e->numBytes};
+    int ok = fwrite("SPVE", 1, 4, file) == 4 &&
+             fwrite(header, sizeof(long long), 4, file) == 4 &&
+             fwrite(e->bytes, 1, e->numBytes, file) == (size_t)e->numBytes &&
+             fwrite(e->values, sizeof(int), e->count, file) == (size_t)e->count;
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) printf("Write to %s failed!\n", path);
+    return ok;
+}
+
+// Check that the byte stream decodes to exactly count gaps, every position
+// lies inside the matrix and no bytes are left over. Returns 1 if valid.
+int validateEncoded(EncodedMatrix* e) {
+    if (e->rows <= 0 || e->cols <= 0 || e->rows > 9223372036854775807LL / e->cols) return 0;
+    if (e->numBytes > 0 && (e->bytes[e->numBytes - 1] & 0x80)) return 0;  // Cut-off varint
+    
+    unsigned long long deltas[ENCODED_BATCH];
+    unsigned long long size = (unsigned long long)(e->rows * e->cols);
+    unsigned long long next = 0;  // Smallest linear index the next entry may have
+    long long offset = 0;
+    long long decoded = 0;
+    
+    while (decoded < e->count) {
+        long long consumed;
+        long long left = e->count - decoded;
+        int n = decodeVarintBatch(e->bytes + offset, e->bytes + e->numBytes, deltas,
+                                  left < ENCODED_BATCH ? (int)left : ENCODED_BATCH, &consumed);
+        if (n <= 0) return 0;
+        offset += consumed;
+        decoded += n;
+        for (int k = 0; k < n; k++) {
+            if (deltas[k] >= size - next) return 0;
+            next += deltas[k] + 1;
+        }
+    }
+    return offset == e->numBytes;
+}
+
+// Load an encoded matrix written by saveEncoded. Returns NULL on failure.
+EncodedMatrix* loadEncoded(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Cannot open %s!\n", path);
+        return NULL;
+    }
+    
+    char magic[4];
+    long long header[4];
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, "SPVE", 4) != 0 ||
+        fread(header, sizeof(long long), 4, file) != 4 || header[0] <= 0 || header[1] <= 0 ||
+        header[2] < 0 || header[3] < 0) {
+        printf("%s is not an encoded sparse matrix!\n", path);
+        fclose(file);
+        return NULL;
+    }
+    
+    EncodedMatrix* e = (EncodedMatrix*)malloc(sizeof(EncodedMatrix));
+    e->rows = header[0];
+    e->cols = header[1];
+    e->count = header[2];
+    e->numBytes = header[3];
+    e->bytes = (unsigned char*)malloc(e->numBytes > 0 ? e->numBytes : 1);
+    e->values = (int*)malloc((e->count > 0 ? e->count : 1) * sizeof(int));
+    
+    int ok = e->bytes != NULL && e->values != NULL &&
+             fread(e->bytes, 1, e->numBytes, file) == (size_t)e->numBytes &&
+             fread(e->values, sizeof(int), e->count, file) == (size_t)e->count;
+    fclose(file);
+    if (!ok) {
+        printf("%s is truncated!\n", path);
+        freeEncoded(e);
+        return NULL;
+    }
+    if (!validateEncoded(e)) {
+        printf("%s has a corrupt index stream!\n", path);
+        freeEncoded(e);
+        return NULL;
+    }
+    return e;
+}
+
+// Population count of a 64-bit word
+int popcount64(unsigned long long x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    int count = 0;
+    while (x) {
+        x &= x - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Index of the lowest set bit of a non-zero word
+int ctz64(unsigned long long x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// Lane permutations for 8-wide compress/expand, indexed by an 8-bit mask.
+// compressTable[m] lists the set lanes first; expandTable[m] maps each set
+// lane to its position among the packed values.
+unsigned char compressTable[256][8];
+unsigned char expandTable[256][8];
+int bitmapTablesReady = 0;
+
+void initBitmapTables() {
+    if (bitmapTablesReady) return;
+    for (int m = 0; m < 256; m++) {
+        int k = 0;
+        for (int lane = 0; lane < 8; lane++) {
+            compressTable[m][lane] = 0;
+            expandTable[m][lane] = 0;
+        }
+        for (int lane = 0; lane < 8; lane++) {
+            if (m & (1 << lane)) {
+                compressTable[m][k] = (unsigned char)lane;
+                expandTable[m][lane] = (unsigned char)k;
+                k++;
+            }
+        }
+    }
+    bitmapTablesReady = 1;
+}
+
+// Scalar compress of one row: set bits and pack non-zeros. Returns count.
+int compressRowScalar(const int* row, int cols, unsigned long long* words, int* out) {
+    int k = 0;
+    for (int w = 0; w * 64 < cols; w++) {
+        unsigned long long bits = 0;
+        int end = (w + 1) * 64 < cols ? (w + 1) * 64 : cols;
+        for (int j = w * 64; j < end; j++) {
+            if (row[j] != 0) {
+                bits |= 1ULL << (j - w * 64);
+                out[k++] = row[j];
+            }
+        }
+        words[w] = bits;
+    }
+    return k;
+}
+
+// Scalar expand of one row back to dense
+void expandRowScalar(const unsigned long long* words, const int* values, int cols, int* row) {
+    int k = 0;
+    for (int w = 0; w * 64 < cols; w++) {
+        int end = (w + 1) * 64 < cols ? (w + 1) * 64 : cols;
+        for (int j = w * 64; j < end; j++) {
+            row[j] = (words[w] >> (j - w * 64)) & 1 ? values[k++] : 0;
+        }
+    }
+}
+
+#ifdef SPMV_X86
+// AVX2 compress: 8 columns at a time, non-zeros moved to the front with a
+// table-driven lane permute. May write up to 7 ints past the packed end.
+__attribute__((target("avx2")))
+int compressRowAVX2(const int* row, int cols, unsigned long long* words, int* out) {
+    int k = 0;
+    __m256i zero = _mm256_setzero_si256();
+    
+    for (int w = 0; w * 64 < cols; w++) {
+        unsigned long long bits = 0;
+        int j = w * 64;
+        int end = (w + 1) * 64 < cols ? (w + 1) * 64 : cols;
+        
+        for (; j + 8 <= end; j += 8) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)&row[j]);
+            int mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, zero))) & 0xFF;
+            __m256i perm = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)compressTable[mask]));
+            _mm256_storeu_si256((__m256i*)&out[k], _mm256_permutevar8x32_epi32(v, perm));
+            k += popcount64((unsigned long long)mask);
+            bits |= (unsigned long long)mask << (j - w * 64);
+        }
+        for (; j < end; j++) {
+            if (row[j] != 0) {
+                bits |= 1ULL << (j - w * 64);
+                out[k++] = row[j];
+            }
+        }
+        words[w] = bits;
+    }
+    return k;
+}
+
+// AVX2 expand: 8 columns at a time, packed values spread back to their
+// lanes and unset lanes zeroed. Reads up to 7 ints past the packed end.
+__attribute__((target("avx2")))
+void expandRowAVX2(const unsigned long long* words, const int* values, int cols, int* row) {
+    int k = 0;
+    __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    
+    for (int w = 0; w * 64 < cols; w++) {
+        int j = w * 64;
+        int end = (w + 1) * 64 < cols ? (w + 1) * 64 : cols;
+        
+        for (; j + 8 <= end; j += 8) {
+            int mask = (int)(words[w] >> (j - w * 64)) & 0xFF;
+            __m256i v = _mm256_loadu_si256((const __m256i*)&values[k]);
+            __m256i perm = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)expandTable[mask]));
+            __m256i keep = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(mask), laneBits), laneBits);
+            _mm256_storeu_si256((__m256i*)&row[j], _mm256_and_si256(_mm256_permutevar8x32_epi32(v, perm), keep));
+            k += popcount64((unsigned long long)mask);
+        }
+        for (; j < end; j++) {
+            row[j] = (words[w] >> (j - w * 64)) & 1 ? values[k++] : 0;
+        }
+    }
+}
+#endif
+
+// Free a bitmap matrix
+void freeBitmap(BitmapMatrix* b) {
+    if (b == NULL) return;
+    free(b->bitmap);
+    free(b->wordRank);
+    free(b->values);
+    free(b);
+}
+
+// Convert a row-major dense buffer to the bitmap layout
+BitmapMatrix* denseToBitmap(const int* dense, int rows, int cols, long long stride) {
+    BitmapMatrix* b = (BitmapMatrix*)malloc(sizeof(BitmapMatrix));
+    long long numWords = (long long)rows * ((cols + 63) / 64);
+    int useAVX2 = detectSpmvKernel() == SPMV_AVX2;
+    
+    initBitmapTables();
+    b->rows = rows;
+    b->cols = cols;
+    b->wordsPerRow = (cols + 63) / 64;
+    b->bitmap = (unsigned long long*)calloc(numWords > 0 ? numWords : 1, sizeof(unsigned long long));
+    b->wordRank = (int*)malloc((numWords + 1) * sizeof(int));
+    
+    // Count first so values is allocated exactly (plus SIMD slack)
+    long long nnz = 0;
+    for (long long i = 0; i < (long long)rows; i++) {
+        const int* row = dense + i * stride;
+        for (int j = 0; j < cols; j++) {
+            nnz += row[j] != 0;
+        }
+    }
+    b->nnz = (int)nnz;
+    b->values = (int*)malloc((nnz + 8) * sizeof(int));
+    
+    int k = 0;
+    for (int i = 0; i < rows; i++) {
+        const int* row = dense + (long long)i * stride;
+        unsigned long long* words = b->bitmap + (long long)i * b->wordsPerRow;
+#ifdef SPMV_X86
+        if (useAVX2) {
+            k += compressRowAVX2(row, cols, words, b->values + k);
+            continue;
+        }
+#endif
+        (void)useAVX2;
+        k += compressRowScalar(row, cols, words, b->values + k);
+    }
+    
+    // Prefix popcounts for constant-time random access
+    b->wordRank[0] = 0;
+    for (long long w = 0; w < numWords; w++) {
+        b->wordRank[w + 1] = b->wordRank[w] + popcount64(b->bitmap[w]);
+    }
+    
+    return b;
+}
+
+// Expand a bitmap matrix into a row-major dense buffer
+void bitmapToDense(BitmapMatrix* b, int* dense, long long stride) {
+    int useAVX2 = detectSpmvKernel() == SPMV_AVX2;
+    
+    initBitmapTables();
+    for (int i = 0; i < b->rows; i++) {
+        long long firstWord = (long long)i * b->wordsPerRow;
+        const int* values = b->values + b->wordRank[firstWord];
+        int* row = dense + (long long)i * stride;
+#ifdef SPMV_X86
+        if (useAVX2) {
+            expandRowAVX2(b->bitmap + firstWord, values, b->cols, row);
+            continue;
+        }
+#endif
+        (void)useAVX2;
+        expandRowScalar(b->bitmap + firstWord, values, b->cols, row);
+    }
+}
+
+// Random access: value at (row, col), 0 if not stored
+int bitmapGet(BitmapMatrix* b, int row, int col) {
+    long long w = (long long)row * b->wordsPerRow + col / 64;
+    int bit = col % 64;
+    if (((b->bitmap[w] >> bit) & 1) == 0) return 0;
+    
+    unsigned long long below = bit == 0 ? 0 : b->bitmap[w] & ((1ULL << bit) - 1);
+    return b->values[b->wordRank[w] + popcount64(below)];
+}
+
+// SpMV y = A*x walking the set bits of each row
+void spmvBitmap(BitmapMatrix* b, const double* x, double* y) {
+    for (int i = 0; i < b->rows; i++) {
+        long long firstWord = (long long)i * b->wordsPerRow;
+        const int* values = b->values + b->wordRank[firstWord];
+        double sum = 0.0;
+        int k = 0;
+        
+        for (int w = 0; w < b->wordsPerRow; w++) {
+            unsigned long long bits = b->bitmap[firstWord + w];
+            const double* xs = x + w * 64;
+            while (bits) {
+                sum += values[k++] * xs[ctz64(bits)];
+                bits &= bits - 1;
+            }
+        }
+        y[i] = sum;
+    }
+}
+
+// One byte range of a Matrix Market body, parsed by one thread
+typedef struct {
+    const char* begin;
+    const char* end;
+    long long rows;
+    long long cols;
+    int isPattern;
+    SparseEntry* out;  // NULL while counting
+    long long count;
+    int error;         // 0, MTX_BAD_ENTRY or MTX_BAD_VALUE
+} MtxChunk;
+
+// Chunk parse errors
+#define MTX_BAD_ENTRY 1  // Malformed line or index out of range
+#define MTX_BAD_VALUE 2  // Value is not an integer that fits in int
+
+// Parse an optionally signed decimal integer, advancing *p
+static long long parseMtxInteger(const char** p, const char* end, int* ok) {
+    const char* s = *p;
+    while (s < end && (*s == ' ' || *s == '\t')) s++;
+    
+    int negative = 0;
+    if (s < end && (*s == '-' || *s == '+')) {
+        negative = (*s == '-');
+        s++;
+    }
+    if (s >= end || *s < '0' || *s > '9') {
+        *ok = 0;
+        *p = s;
+        return 0;
+    }
+    
+    long long value = 0;
+    while (s < end && *s >= '0' && *s <= '9') {
+        if (value > (9223372036854775807LL - 9) / 10) {
+            *ok = 0;  // Would overflow
+            break;
+        }
+        value = value * 10 + (*s - '0');
+        s++;
+    }
+    *p = s;
+    return negative ? -value : value;
+}
+
+// Count (out == NULL) or parse the coordinate lines of one chunk.
+// Blank lines and '%' comment lines are skipped in both passes.
+void* parseMtxChunk(void* arg) {
+    MtxChunk* c = (MtxChunk*)arg;
+    const char* p = c->begin;
+    long long k = 0;
+    
+    while (p < c->end) {
+        const char* lineEnd = memchr(p, '\n', c->end - p);
+        if (lineEnd == NULL) lineEnd = c->end;
+        
+        const char* s = p;
+        while (s < lineEnd && (*s == ' ' || *s == '\t' || *s == '\r')) s++;
+        
+        if (s < lineEnd && *s != '%') {
+            if (c->out != NULL) {
+                int ok = 1;
+                long long row = parseMtxInteger(&s, lineEnd, &ok);
+                long long col = parseMtxInteger(&s, lineEnd, &ok);
+                if (!ok || row < 1 || row > c->rows || col < 1 || col > c->cols) {
+                    c->error = MTX_BAD_ENTRY;
+                    return NULL;
+                }
+                
+                // Values are stored as int: anything after the digits
+                // (".5", "e3") or beyond the int range is rejected
+                long long value = 1;
+                if (!c->isPattern) {
+                    value = parseMtxInteger(&s, lineEnd, &ok);
+                    while (s < lineEnd && (*s == ' ' || *s == '\t' || *s == '\r')) s++;
+                    if (!ok || s < lineEnd || value < -2147483647LL - 1 || value > 2147483647LL) {
+                        c->error = MTX_BAD_VALUE;
+                        return NULL;
+                    }
+                }
+                c->out[k].row = row - 1;
+                c->out[k].col = col - 1;
+                c->out[k].value = (int)value;
+            }
+            k++;
+        }
+        p = lineEnd + 1;
+    }
+    
+    c->count = k;
+    return NULL;
+}
+
+// Run one pass of the chunk parser on all chunks in parallel
+void runMtxChunks(MtxChunk chunks[], int numChunks) {
+    runParallel(parseMtxChunk, chunks, sizeof(MtxChunk), numChunks);
+}
+
+// Load a Matrix Market coordinate file (integer or pattern field).
+// The file is mmapped and its body parsed in numThreads chunks: a counting
+// pass assigns each chunk its output offset, then a second pass parses
+// straight into the entry array. Symmetric files are expanded to general.
+SparseMatrix* loadMatrixMarket(const char* path, int numThreads) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Cannot open %s!\n", path);
+        return NULL;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("Cannot read %s!\n", path);
+        close(fd);
+        return NULL;
+    }
+    
+    size_t length = (size_t)st.st_size;
+    char* data = (char*)mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("Cannot map %s!\n", path);
+        return NULL;
+    }
+    madvise(data, length, MADV_SEQUENTIAL);
+    
+    const char* end = data + length;
+    const char* p = data;
+    const char* lineEnd = memchr(p, '\n', end - p);
+    if (lineEnd == NULL) lineEnd = end;
+    
+    // Banner: %%MatrixMarket matrix coordinate <field> <symmetry>
+    char banner[256];
+    size_t bannerLength = lineEnd - p < 255 ? (size_t)(lineEnd - p) : 255;
+    memcpy(banner, p, bannerLength);
+    banner[bannerLength] = '\0';
+    for (size_t i = 0; i < bannerLength; i++) {
+        if (banner[i] >= 'A' && banner[i] <= 'Z') banner[i] += 'a' - 'A';
+    }
+    
+    if (strncmp(banner, "%%matrixmarket matrix coordinate", 32) != 0) {
+        printf("%s is not a Matrix Market coordinate file!\n", path);
+        munmap(data, length);
+        return NULL;
+    }
+    int isPattern = strstr(banner, " pattern") != NULL;
+    int isSymmetric = strstr(banner, " symmetric") != NULL;
+    int isSkew = strstr(banner, " skew-symmetric") != NULL;
+    if (!isPattern && strstr(banner, " integer") == NULL) {
+        printf("Only integer and pattern fields are supported (values are stored as int)!\n");
+        munmap(data, length);
+        return NULL;
+    }
+    if (!isSymmetric && !isSkew && strstr(banner, " general") == NULL) {
+        printf("Unsupported symmetry in %s!\n", path);
+        munmap(data, length);
+        return NULL;
+    }
+    
+    // Skip comments and blank lines to the size line: rows cols nonzeros
+    p = lineEnd < end ? lineEnd + 1 : end;
+    while (p < end) {
+        lineEnd = memchr(p, '\n', end - p);
+        if (lineEnd == NULL) lineEnd = end;
+        const char* s = p;
+        while (s < lineEnd && (*s == ' ' || *s == '\t' || *s == '\r')) s++;
+        if (s < lineEnd && *s != '%') break;
+        p = lineEnd < end ? lineEnd + 1 : end;
+    }
+    if (p == end) lineEnd = end;
+    
+    // Exactly three integers, then only whitespace
+    int ok = 1;
+    long long rows = parseMtxInteger(&p, lineEnd, &ok);
+    long long cols = parseMtxInteger(&p, lineEnd, &ok);
+    long long declared = parseMtxInteger(&p, lineEnd, &ok);
+    while (p < lineEnd && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    if (!ok || p < lineEnd || rows < 0 || cols < 0 || declared < 0) {
+        printf("Bad size line in %s!\n", path);
+        munmap(data, length);
+        return NULL;
+    }
+    const char* body = lineEnd < end ? lineEnd + 1 : end;
+    
+    // Split the body into newline-aligned chunks
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAX_THREADS) numThreads = MAX_THREADS;
+    if ((end - body) < numThreads * 4096L) numThreads = 1;
+    
+    MtxChunk chunks[MAX_THREADS];
+    const char* cursor = body;
+    for (int t = 0; t < numThreads; t++) {
+        const char* chunkEnd = t == numThreads - 1 ? end : body + (end - body) / numThreads * (t + 1);
+        if (chunkEnd < cursor) chunkEnd = cursor;
+        if (chunkEnd < end) {
+            const char* nl = memchr(chunkEnd, '\n', end - chunkEnd);
+            chunkEnd = nl == NULL ? end : nl + 1;
+        }
+        chunks[t].begin = cursor;
+        chunks[t].end = chunkEnd;
+        chunks[t].rows = rows;
+        chunks[t].cols = cols;
+        chunks[t].isPattern = isPattern;
+        chunks[t].out = NULL;
+        chunks[t].count = 0;
+        chunks[t].error = 0;
+        cursor = chunkEnd;
+    }
+    
+    // Pass 1: count lines per chunk, prefix sum gives output offsets
+    runMtxChunks(chunks, numThreads);
+    long long total = 0;
+    for (int t = 0; t < numThreads; t++) {
+        total += chunks[t].count;
+    }
+    if (total != declared) {
+        printf("%s declares %lld entries but has %lld!\n", path, declared, total);
+        munmap(data, length);
+        return NULL;
+    }
+    
+    SparseMatrix* m = createSparseMatrix(rows, cols, (isSymmetric || isSkew) ? total * 2 : total);
+    if (m == NULL) {
+        printf("Out of memory loading %s!\n", path);
+        munmap(data, length);
+        return NULL;
+    }
+    
+    // Pass 2: parse each chunk directly into its slice
+    long long offset = 0;
+    for (int t = 0; t < numThreads; t++) {
+        chunks[t].out = m->entries + offset;
+        offset += chunks[t].count;
+    }
+    runMtxChunks(chunks, numThreads);
+    munmap(data, length);
+    
+    for (int t = 0; t < numThreads; t++) {
+        if (chunks[t].error == MTX_BAD_VALUE) {
+            printf("Non-integer or out-of-int-range value in %s!\n", path);
+            freeSparseMatrix(m);
+            return NULL;
+        }
+        if (chunks[t].error) {
+            printf("Malformed or out-of-range entry in %s!\n", path);
+            freeSparseMatrix(m);
+            return NULL;
+        }
+    }
+    m->count = total;
+    
+    // Mirror the stored triangle for symmetric storage
+    if (isSymmetric || isSkew) {
+        for (long long i = 0; i < total; i++) {
+            SparseEntry e = m->entries[i];
+            if (e.row != e.col) {
+                appendEntry(m, e.col, e.row, isSkew ? -e.value : e.value);
+            }
+        }
+    }
+    
+    return m;
+}
+
+// Append the decimal form of value to buf, returning characters written
+static int formatMtxInteger(char* buf, long long value) {
+    char digits[24];
+    int n = 0;
+    int length = 0;
+    unsigned long long v = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    
+    if (value < 0) buf[length++] = '-';
+    while (n > 0) buf[length++] = digits[--n];
+    return length;
+}
+
+// Write a sparse matrix as a Matrix Market integer general coordinate file.
+// Returns 1 on success, 0 on failure.
+int writeMatrixMarket(const char* path, SparseMatrix* m) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        printf("Cannot create %s!\n", path);
+        return 0;
+    }
+    
+    char* buffer = (char*)malloc(MTX_WRITE_BUFFER);
+    if (buffer == NULL) {
+        fclose(file);
+        return 0;
+    }
+    
+    int used = snprintf(buffer, MTX_WRITE_BUFFER,
+                        "%%%%MatrixMarket matrix coordinate integer general\n%lld %lld %lld\n",
+                        m->rows, m->cols, m->count);
+    int ok = 1;
+    
+    for (long long i = 0; i < m->count && ok; i++) {
+        // A line is at most 3 numbers of 20 digits plus separators
+        if (used > MTX_WRITE_BUFFER - 72) {
+            ok = fwrite(buffer, 1, used, file) == (size_t)used;
+            used = 0;
+        }
+        used += formatMtxInteger(buffer + used, m->entries[i].row + 1);
+        buffer[used++] = ' ';
+        used += formatMtxInteger(buffer + used, m->entries[i].col + 1);
+        buffer[used++] = ' ';
+        used += formatMtxInteger(buffer + used, m->entries[i].value);
+        buffer[used++] = '\n';
+    }
+    if (ok && used > 0) {
+        ok = fwrite(buffer, 1, used, file) == (size_t)used;
+    }
+    
+    free(buffer);
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) printf("Write to %s failed!\n", path);
+    return ok;
+}
+
+// Monotonic wall clock in seconds
+double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Fused x += alpha*p, r -= alpha*q, z = r / diag (or r), returning
+// dot(r, r) in rr and dot(r, z) as the result, all in one pass
+double fusedUpdate(int n, double alpha, const double* p, const double* q, const double* invDiag,
+                   double* x, double* r, double* z, double* rr) {
+    double rrSum = 0.0;
+    double rzSum = 0.0;
+    
+    if (invDiag != NULL) {
+        for (int i = 0; i < n; i++) {
+            x[i] += alpha * p[i];
+            double ri = r[i] - alpha * q[i];
+            double zi = ri * invDiag[i];
+            r[i] = ri;
+            z[i] = zi;
+            rrSum += ri * ri;
+            rzSum += ri * zi;
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            x[i] += alpha * p[i];
+            double ri = r[i] - alpha * q[i];
+            r[i] = ri;
+            rrSum += ri * ri;
+        }
+        rzSum = rrSum;
+    }
+    
+    *rr = rrSum;
+    return rzSum;
+}
+
+// Dot product
+double dotProduct(int n, const double* a, const double* b) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// Free the per-iteration arrays of a SolverStats
+void freeSolverStats(SolverStats* stats) {
+    free(stats->iterationSeconds);
+    free(stats->iterationResidual);
+    stats->iterationSeconds = NULL;
+    stats->iterationResidual = NULL;
+}
+
+// Solve A x = b for symmetric positive definite CSR A by (preconditioned)
+// conjugate gradients. x holds the initial guess on entry. Returns 1 if
+// the tolerance was reached; stats must be released with freeSolverStats.
+int conjugateGradient(CompressedMatrix* a, const double* b, double* x,
+                      SolverOptions* options, SolverStats* stats) {
+    int n = a->rows;
+    double start = nowSeconds();
     
-    // Store matrix dimensions in first element
-    sparse[0].row = rows;
-    sparse[0].col = cols;
-    sparse[0].value = 0; // Will store count of non-zero elements
+    memset(stats, 0, sizeof(SolverStats));
+    if (a->isColumnMajor || a->rows != a->cols) {
+        printf("CG needs a square CSR matrix!\n");
+        return 0;
+    }
     
-    k = 1;
+    stats->iterationSeconds = (double*)calloc(options->maxIterations + 1, sizeof(double));
+    stats->iterationResidual = (double*)calloc(options->maxIterations + 1, sizeof(double));
+    double* r = (double*)malloc(n * sizeof(double));
+    double* z = (double*)malloc(n * sizeof(double));
+    double* p = (double*)malloc(n * sizeof(double));
+    double* q = (double*)malloc(n * sizeof(double));
+    double* invDiag = NULL;
     
-    // Traverse the matrix and store non-zero elements
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            if (matrix[i][j] != 0) {
+    // Jacobi preconditioner: inverse of the diagonal
+    if (options->useJacobi) {
+        invDiag = (double*)malloc(n * sizeof(double));
+        for (int i = 0; i < n; i++) {
+            invDiag[i] = 0.0;
+            for (int k = a->ptr[i]; k < a->ptr[i + 1]; k++) {
+                if (a->idx[k] == i) invDiag[i] += a->values[k];
+            }
+            if (invDiag[i] == 0.0) {
+                printf("Zero diagonal at row %d; Jacobi disabled.\n", i);
+                free(invDiag);
+                invDiag = NULL;
+                break;
+            }
+            invDiag[i] = 1.0 / invDiag[i];
+        }
+    }
+    
+    // r = b - A x, z = M^-1 r, p = z
+    spmv(a, x, q);
+    double rr = 0.0;
+    double rz = 0.0;
+    for (int i = 0; i < n; i++) {
+        r[i] = b[i] - q[i];
+        z[i] = invDiag != NULL ? r[i] * invDiag[i] : r[i];
+        p[i] = z[i];
+        rr += r[i] * r[i];
+        rz += r[i] * z[i];
+    }
+    
+    double bNorm = sqrt(dotProduct(n, b, b));
+    if (bNorm == 0.0) bNorm = 1.0;
+    stats->residual = sqrt(rr) / bNorm;
+    
+    while (stats->residual > options->tolerance && stats->iterations < options->maxIterations) {
+        double iterStart = nowSeconds();
+        
+        spmv(a, p, q);
+        double afterSpmv = nowSeconds();
+        stats->spmvSeconds += afterSpmv - iterStart;
+        
+        double pq = dotProduct(n, p, q);
+        if (pq <= 0.0) {
+            printf("Matrix is not positive definite (p'Ap = %g)!\n", pq);
+            break;
+        }
+        double alpha = rz / pq;
+        double rzNew = fusedUpdate(n, alpha, p, q, invDiag, x, r, z, &rr);
+        double beta = rzNew / rz;
+        rz = rzNew;
+        
+        const double* dir = invDiag != NULL ? z : r;
+        for (int i = 0; i < n; i++) {
+            p[i] = dir[i] + beta * p[i];
+        }
+        
+        double iterEnd = nowSeconds();
+        stats->vectorSeconds += iterEnd - afterSpmv;
+        stats->residual = sqrt(rr) / bNorm;
+        stats->iterationSeconds[stats->iterations] = iterEnd - iterStart;
+        stats->iterationResidual[stats->iterations] = stats->residual;
+        stats->iterations++;
+    }
+    
+    stats->converged = stats->residual <= options->tolerance;
+    stats->totalSeconds = nowSeconds() - start;
+    
+    free(r);
+    free(z);
+    free(p);
+    free(q);
+    free(invDiag);
+    return stats->converged;
+}
+
+// Solve a 2D Poisson-like system with plain CG and Jacobi-CG
+void demoConjugateGradient() {
+    int grid = 100;
+    int n = grid * grid;
+    SparseMatrix* m = createSparseMatrix(n, n, (long long)n * 5);
+    
+    // 5-point stencil with a varying diagonal so Jacobi has work to do
+    for (int i = 0; i < n; i++) {
+        int gx = i % grid;
+        int gy = i / grid;
+        if (gy > 0) appendEntry(m, i, i - grid, -1);
+        if (gx > 0) appendEntry(m, i, i - 1, -1);
+        appendEntry(m, i, i, 4 + (i % 17) * 8);
+        if (gx < grid - 1) appendEntry(m, i, i + 1, -1);
+        if (gy < grid - 1) appendEntry(m, i, i + grid, -1);
+    }
+    CompressedMatrix* a = sparseMatrixToCompressed(m, 0);
+    freeSparseMatrix(m);
+    
+    double* b = (double*)malloc(n * sizeof(double));
+    double* x = (double*)malloc(n * sizeof(double));
+    double* check = (double*)malloc(n * sizeof(double));
+    for (int i = 0; i < n; i++) {
+        b[i] = 1.0 + (i % 13) * 0.1;
+    }
+    
+    printf("\n=== Conjugate Gradient (%d unknowns, %d non-zeros) ===\n\n", n, a->nnz);
+    printf("%-10s %-8s %-12s %-10s %-10s %-10s %-12s\n",
+           "Method", "Iters", "Residual", "Total ms", "SpMV ms", "Vector ms", "us/iter");
+    printf("------------------------------------------------------------------------------\n");
+    
+    for (int jacobi = 0; jacobi <= 1; jacobi++) {
+        SolverOptions options = {1e-10, 1000, jacobi};
+        SolverStats stats;
+        
+        for (int i = 0; i < n; i++) {
+            x[i] = 0.0;
+        }
+        conjugateGradient(a, b, x, &options, &stats);
+        
+        // Independent residual check
+        spmv(a, x, check);
+        double err = 0.0;
+        for (int i = 0; i < n; i++) {
+            err += (b[i] - check[i]) * (b[i] - check[i]);
+        }
+        
+        // Median iteration time
+        double medianIter = 0.0;
+        if (stats.iterations > 0) {
+            double* times = (double*)malloc(stats.iterations * sizeof(double));
+            memcpy(times, stats.iterationSeconds, stats.iterations * sizeof(double));
+            qsort(times, stats.iterations, sizeof(double), compareDouble);
+            medianIter = times[stats.iterations / 2];
+            free(times);
+        }
+        
+        printf("%-10s %-8d %-12.2e %-10.3f %-10.3f %-10.3f %-12.2f%s\n",
+               jacobi ? "Jacobi-CG" : "CG", stats.iterations,
+               sqrt(err) / sqrt(dotProduct(n, b, b)), stats.totalSeconds * 1e3,
+               stats.spmvSeconds * 1e3, stats.vectorSeconds * 1e3, medianIter * 1e6,
+               stats.converged ? "" : "  (not converged)");
+        freeSolverStats(&stats);
+    }
+    
+    free(b);
+    free(x);
+    free(check);
+    freeCompressed(a);
+}
+
+// Build a random n x n triplet array (row-major) with the given density.
+// Returns total elements (including header); caller frees *out.
+int randomSparse(int n, double density, unsigned int seed, SparseElement** out) {
+    long long expected = (long long)((double)n * n * density) + n + 1;
+    SparseElement* sparse = (SparseElement*)malloc(expected * sizeof(SparseElement));
+    int k = 1;
+    
+    srand(seed);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if ((double)rand() / RAND_MAX < density && k < expected) {
                 sparse[k].row = i;
                 sparse[k].col = j;
-                sparse[k].value = matrix[i][j];
+                sparse[k].value = rand() % 19 - 9;
+                if (sparse[k].value == 0) sparse[k].value = 1;
                 k++;
             }
         }
     }
-    
-    // Store the count of non-zero elements
+    sparse[0].row = n;
+    sparse[0].col = n;
     sparse[0].value = k - 1;
     
-    return k; // Return total elements (including header)
+    *out = sparse;
+    return k;
 }
 
-// Function to display regular matrix
-void displayMatrix(int matrix[][10], int rows, int cols) {
-    printf("\nOriginal Matrix (%dx%d):\n", rows, cols);
-    printf("------------------------\n");
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            printf("%4d ", matrix[i][j]);
+// SpMV throughput benchmark across sparsity ratios and kernels
+void benchmarkSpmv() {
+    int n = 4000;
+    double densities[] = {0.001, 0.01, 0.05, 0.10};
+    int numDensities = 4;
+    int best = detectSpmvKernel();
+    
+    printf("\n=== SpMV Benchmark (%dx%d, CSR, best kernel: %s) ===\n\n",
+           n, n, spmvKernelName(best));
+    printf("%-8s %-10s %-8s %-10s %-10s %-10s %-10s\n",
+           "Density", "Nonzeros", "Kernel", "GFLOP/s", "Bytes/nnz", "GB/s", "MaxError");
+    printf("--------------------------------------------------------------------------\n");
+    
+    for (int d = 0; d < numDensities; d++) {
+        SparseElement* sparse;
+        int size = randomSparse(n, densities[d], 42 + d, &sparse);
+        CompressedMatrix* csr = sparseToCompressed(sparse, size, 0);
+        free(sparse);
+        
+        double* x = (double*)malloc(n * sizeof(double));
+        double* ref = (double*)malloc(n * sizeof(double));
+        double* y = (double*)malloc(n * sizeof(double));
+        for (int i = 0; i < n; i++) {
+            x[i] = 1.0 + (i % 7) * 0.25;
         }
-        printf("\n");
+        spmvScalar(csr, x, ref);
+        
+        // Matrix arrays plus one pass over x and y per multiply
+        double bytes = (double)compressedBytes(n, csr->nnz) + 2.0 * n * sizeof(double);
+        
+        for (int kernel = SPMV_SCALAR; kernel <= best; kernel++) {
+            // Repeat until at least ~0.2 seconds have elapsed
+            int reps = 0;
+            double start = nowSeconds();
+            double elapsed = 0.0;
+            do {
+                spmvWithKernel(csr, x, y, kernel);
+                reps++;
+                elapsed = nowSeconds() - start;
+            } while (elapsed < 0.2);
+            
+            double maxError = 0.0;
+            for (int i = 0; i < n; i++) {
+                double diff = y[i] > ref[i] ? y[i] - ref[i] : ref[i] - y[i];
+                if (diff > maxError) maxError = diff;
+            }
+            
+            double perCall = elapsed / reps;
+            printf("%-8.3f %-10d %-8s %-10.3f %-10.2f %-10.2f %-10.2e\n",
+                   densities[d], csr->nnz, spmvKernelName(kernel),
+                   2.0 * csr->nnz / perCall * 1e-9,
+                   csr->nnz > 0 ? bytes / csr->nnz : 0.0,
+                   bytes / perCall * 1e-9, maxError);
+        }
+        
+        free(x);
+        free(ref);
+        free(y);
+        freeCompressed(csr);
     }
 }
 
-// Function to display sparse matrix
-void displaySparse(SparseElement sparse[], int size) {
-    printf("\nSparse Matrix Representation:\n");
-    printf("-----------------------------\n");
-    printf(" Row | Column | Value\n");
-    printf("-----|--------|------\n");
+// Load a Matrix Market file given on the command line and report throughput
+int loadMatrixMarketCommand(const char* path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        printf("Cannot open %s!\n", path);
+        return 1;
+    }
     
-    // First row contains dimensions and count
-    printf("%4d | %6d | %5d  <- (rows, cols, count)\n", 
-           sparse[0].row, sparse[0].col, sparse[0].value);
-    printf("-----|--------|------\n");
+    int threads = onlineCpus();
+    double start = nowSeconds();
+    SparseMatrix* m = loadMatrixMarket(path, threads);
+    double elapsed = nowSeconds() - start;
+    if (m == NULL) return 1;
     
-    // Print non-zero elements
-    for (int i = 1; i < size; i++) {
-        printf("%4d | %6d | %5d\n", 
-               sparse[i].row, sparse[i].col, sparse[i].value);
+    printf("\n=== Matrix Market Load ===\n");
+    printf("File:        %s\n", path);
+    printf("Dimensions:  %lld x %lld\n", m->rows, m->cols);
+    printf("Nonzeros:    %lld\n", m->count);
+    printf("Threads:     %d\n", threads);
+    printf("Load time:   %.4f seconds\n", elapsed);
+    printf("Throughput:  %.1f MB/s\n", st.st_size / elapsed / 1e6);
+    calculateSavings(m->rows, m->cols, m->count);
+    
+    freeSparseMatrix(m);
+    return 0;
+}
+
+// Write/load round trip of a generated matrix through a temporary .mtx file
+void benchmarkMatrixMarket() {
+    long long n = 200000;
+    long long perRow = 10;
+    char path[] = "/tmp/sparse_bench_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        printf("Cannot create temporary file!\n");
+        return;
+    }
+    close(fd);
+    
+    SparseMatrix* m = createSparseMatrix(n, n, n * perRow);
+    srand(7);
+    for (long long i = 0; i < n; i++) {
+        for (long long k = 0; k < perRow; k++) {
+            appendEntry(m, i, (i * 7919 + k * 104729 + rand()) % n, rand() % 2001 - 1000);
+        }
+    }
+    
+    double start = nowSeconds();
+    int written = writeMatrixMarket(path, m);
+    double writeTime = nowSeconds() - start;
+    struct stat st;
+    if (!written || stat(path, &st) != 0) {
+        freeSparseMatrix(m);
+        remove(path);
+        return;
+    }
+    
+    printf("\n=== Matrix Market I/O (%lld x %lld, %lld nonzeros, %.1f MB) ===\n\n",
+           n, n, m->count, st.st_size / 1e6);
+    printf("%-8s %-12s %-10s %-8s\n", "Threads", "Time (s)", "MB/s", "Verified");
+    printf("------------------------------------------\n");
+    printf("%-8s %-12.4f %-10.1f %-8s\n", "write", writeTime, st.st_size / writeTime / 1e6, "-");
+    
+    int maxThreads = onlineCpus() < MAX_THREADS ? onlineCpus() : MAX_THREADS;
+    
+    // Thread counts 1, 2, 4, ... and finally all CPUs
+    for (int threads = 1; ; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads) {
+        start = nowSeconds();
+        SparseMatrix* loaded = loadMatrixMarket(path, threads);
+        double loadTime = nowSeconds() - start;
+        if (loaded == NULL) break;
+        
+        int same = sameSparseMatrix(loaded, m);
+        printf("%-8d %-12.4f %-10.1f %-8s\n", threads, loadTime,
+               st.st_size / loadTime / 1e6, same ? "OK" : "MISMATCH");
+        freeSparseMatrix(loaded);
+        
+        if (threads >= maxThreads) break;
     }
+    
+    freeSparseMatrix(m);
+    remove(path);
 }
 
-// Function to calculate space savings
-void calculateSavings(int rows, int cols, int nonZeroCount) {
-    int originalSize = rows * cols * sizeof(int);
-    int sparseSize = (nonZeroCount + 1) * sizeof(SparseElement);
-    float savingsPercent = ((float)(originalSize - sparseSize) / originalSize) * 100;
+// Serial vs parallel dense-to-sparse conversion on a 10% dense matrix
+void benchmarkConversion() {
+    long long rows = 4000;
+    long long cols = 4000;
+    int* dense = (int*)malloc(rows * cols * sizeof(int));
     
-    printf("\n=== Memory Analysis ===\n");
-    printf("Original matrix size: %d elements × %lu bytes = %d bytes\n", 
-           rows * cols, sizeof(int), originalSize);
-    printf("Sparse matrix size: %d elements × %lu bytes = %d bytes\n", 
-           nonZeroCount + 1, sizeof(SparseElement), sparseSize);
-    printf("Space savings: %.2f%%\n", savingsPercent);
-    printf("Compression ratio: %.2fx\n", (float)originalSize / sparseSize);
+    srand(11);
+    for (long long i = 0; i < rows * cols; i++) {
+        dense[i] = rand() % 10 == 0 ? rand() % 100 + 1 : 0;
+    }
+    
+    printf("\n=== Dense -> Sparse Conversion (%lld x %lld, 10%% non-zero) ===\n\n", rows, cols);
+    printf("%-10s %-12s %-10s %-8s\n", "Threads", "Time (s)", "Speedup", "Matches");
+    printf("------------------------------------------\n");
+    
+    double start = nowSeconds();
+    SparseMatrix* serial = convertDenseToSparse(dense, rows, cols, cols);
+    double serialTime = nowSeconds() - start;
+    printf("%-10s %-12.4f %-10.2f %-8s\n", "serial", serialTime, 1.0, "-");
+    
+    int maxThreads = onlineCpus() < MAX_THREADS ? onlineCpus() : MAX_THREADS;
+    for (int threads = 1; ; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads) {
+        start = nowSeconds();
+        SparseMatrix* parallel = convertDenseToSparseParallel(dense, rows, cols, cols, threads);
+        double elapsed = nowSeconds() - start;
+        
+        int same = sameSparseMatrix(parallel, serial);
+        printf("%-10d %-12.4f %-10.2f %-8s\n", threads, elapsed, serialTime / elapsed,
+               same ? "OK" : "MISMATCH");
+        freeSparseMatrix(parallel);
+        
+        if (threads >= maxThreads) break;
+    }
+    
+    freeSparseMatrix(serial);
+    free(dense);
 }
 
-// Function to reconstruct original matrix from sparse representation
-void reconstructMatrix(SparseElement sparse[], int size, int result[][10]) {
-    int rows = sparse[0].row;
-    int cols = sparse[0].col;
+// CSR vs BSR SpMV on a matrix made of randomly placed dense tiles
+void benchmarkBlockSpmv() {
+    int n = 4096;
+    int tilesPerBlockRow = 16;
+    int blockRows = n / BSR_BLOCK;
+    SparseMatrix* m = createSparseMatrix(n, n, (long long)n * tilesPerBlockRow * BSR_BLOCK);
     
-    // Initialize result matrix with zeros
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            result[i][j] = 0;
+    // Clustered non-zeros: ~90% filled tiles at random block columns
+    srand(5);
+    for (int br = 0; br < blockRows; br++) {
+        int bcs[64];
+        for (int t = 0; t < tilesPerBlockRow; t++) {
+            bcs[t] = rand() % (n / BSR_BLOCK);
+        }
+        qsort(bcs, tilesPerBlockRow, sizeof(int), compareInt);
+        for (int r = 0; r < BSR_BLOCK; r++) {
+            for (int t = 0; t < tilesPerBlockRow; t++) {
+                if (t > 0 && bcs[t] == bcs[t - 1]) continue;
+                for (int c = 0; c < BSR_BLOCK; c++) {
+                    if (rand() % 10 != 0) {
+                        appendEntry(m, br * BSR_BLOCK + r, bcs[t] * BSR_BLOCK + c, rand() % 9 + 1);
+                    }
+                }
+            }
         }
     }
     
-    // Fill in non-zero values
-    for (int i = 1; i < size; i++) {
-        result[sparse[i].row][sparse[i].col] = sparse[i].value;
+    CompressedMatrix* csr = sparseMatrixToCompressed(m, 0);
+    BlockMatrix* bsr = compressedToBlock(csr);
+    freeSparseMatrix(m);
+    
+    double* x = (double*)malloc(n * sizeof(double));
+    double* ref = (double*)malloc(n * sizeof(double));
+    double* y = (double*)malloc(n * sizeof(double));
+    for (int i = 0; i < n; i++) {
+        x[i] = 1.0 + (i % 5) * 0.5;
+    }
+    spmvScalar(csr, x, ref);
+    
+    printf("\n=== Block SpMV (%dx%d, %dx%d tiles, %d non-zeros, %d tiles, fill %.2f) ===\n\n",
+           n, n, BSR_BLOCK, BSR_BLOCK, csr->nnz, bsr->numBlocks,
+           (double)bsr->numBlocks * BSR_BLOCK * BSR_BLOCK / csr->nnz);
+    printf("%-8s %-10s %-12s %-10s\n", "Format", "GFLOP/s", "Bytes/nnz", "MaxError");
+    printf("------------------------------------------\n");
+    
+    double gflops[2];
+    for (int format = 0; format < 2; format++) {
+        int reps = 0;
+        double start = nowSeconds();
+        double elapsed = 0.0;
+        do {
+            if (format == 0) spmv(csr, x, y);
+            else spmvBlock(bsr, x, y);
+            reps++;
+            elapsed = nowSeconds() - start;
+        } while (elapsed < 0.2);
+        
+        double maxError = 0.0;
+        for (int i = 0; i < n; i++) {
+            double diff = y[i] > ref[i] ? y[i] - ref[i] : ref[i] - y[i];
+            if (diff > maxError) maxError = diff;
+        }
+        
+        long long bytes = format == 0 ? compressedBytes(n, csr->nnz) : blockBytes(bsr);
+        gflops[format] = 2.0 * csr->nnz / (elapsed / reps) * 1e-9;
+        printf("%-8s %-10.3f %-12.2f %-10.2e\n", format == 0 ? "CSR" : "BSR",
+               gflops[format], (double)bytes / csr->nnz, maxError);
+    }
+    if (gflops[1] > gflops[0]) {
+        printf("\nBSR is %.2fx faster than CSR on this matrix.\n", gflops[1] / gflops[0]);
+    } else {
+        printf("\nBSR is slower than CSR on this matrix (%.2fx); the tiles do not pay off here.\n",
+               gflops[1] / gflops[0]);
+    }
+    
+    free(x);
+    free(ref);
+    free(y);
+    freeBlock(bsr);
+    freeCompressed(csr);
+}
+
+// CSR vs delta/varint encoded SpMV across densities
+void benchmarkEncodedSpmv() {
+    int n = 4000;
+    double densities[] = {0.001, 0.01, 0.05};
+    int numDensities = 3;
+    
+    printf("\n=== Encoded SpMV (%dx%d) ===\n\n", n, n);
+    printf("Varint is a storage format: it trades SpMV speed for fewer bytes.\n\n");
+    printf("%-8s %-8s %-10s %-12s %-10s\n", "Density", "Format", "GFLOP/s", "Bytes/nnz", "MaxError");
+    printf("----------------------------------------------------\n");
+    
+    for (int d = 0; d < numDensities; d++) {
+        SparseElement* sparse;
+        int size = randomSparse(n, densities[d], 77 + d, &sparse);
+        CompressedMatrix* csr = sparseToCompressed(sparse, size, 0);
+        EncodedMatrix* enc = compressedToEncoded(csr);
+        free(sparse);
+        
+        double* x = (double*)malloc(n * sizeof(double));
+        double* ref = (double*)malloc(n * sizeof(double));
+        double* y = (double*)malloc(n * sizeof(double));
+        for (int i = 0; i < n; i++) {
+            x[i] = 1.0 + (i % 3) * 0.5;
+        }
+        spmvScalar(csr, x, ref);
+        
+        for (int format = 0; format < 2; format++) {
+            int reps = 0;
+            double start = nowSeconds();
+            double elapsed = 0.0;
+            do {
+                if (format == 0) spmv(csr, x, y);
+                else spmvEncoded(enc, x, y);
+                reps++;
+                elapsed = nowSeconds() - start;
+            } while (elapsed < 0.2);
+            
+            double maxError = 0.0;
+            for (int i = 0; i < n; i++) {
+                double diff = y[i] > ref[i] ? y[i] - ref[i] : ref[i] - y[i];
+                if (diff > maxError) maxError = diff;
+            }
+            
+            long long bytes = format == 0 ? compressedBytes(n, csr->nnz) : encodedBytes(enc);
+            printf("%-8.3f %-8s %-10.3f %-12.2f %-10.2e\n", densities[d],
+                   format == 0 ? "CSR" : "Varint", 2.0 * csr->nnz / (elapsed / reps) * 1e-9,
+                   csr->nnz > 0 ? (double)bytes / csr->nnz : 0.0, maxError);
+        }
+        
+        free(x);
+        free(ref);
+        free(y);
+        freeEncoded(enc);
+        freeCompressed(csr);
     }
 }
 
-int main() {
+// Reproducible xorshift64* generator for the benchmark suite
+unsigned long long nextRandom(unsigned long long* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// Uniform double in [0, 1)
+double nextUniform(unsigned long long* state) {
+    return (nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Non-zero value in [-9, 9]
+int nextValue(unsigned long long* state) {
+    int v = (int)(nextRandom(state) % 18) - 9;
+    return v >= 0 ? v + 1 : v;
+}
+
+// Fill an n x n dense buffer with one of the suite's sparsity patterns:
+// "random" (uniform), "banded" (diagonal band), "powerlaw" (Zipf row
+// degrees) or "block" (8x8 clusters). Roughly density * n * n non-zeros.
+int generatePattern(const char* pattern, int n, double density, unsigned long long seed, int* dense) {
+    unsigned long long state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    memset(dense, 0, (size_t)n * n * sizeof(int));
+    
+    if (strcmp(pattern, "random") == 0) {
+        for (long long i = 0; i < (long long)n * n; i++) {
+            if (nextUniform(&state) < density) dense[i] = nextValue(&state);
+        }
+    } else if (strcmp(pattern, "banded") == 0) {
+        int halfWidth = (int)(density * n / 2);
+        for (int i = 0; i < n; i++) {
+            int first = i - halfWidth > 0 ? i - halfWidth : 0;
+            int last = i + halfWidth < n - 1 ? i + halfWidth : n - 1;
+            for (int j = first; j <= last; j++) {
+                dense[(long long)i * n + j] = nextValue(&state);
+            }
+        }
+    } else if (strcmp(pattern, "powerlaw") == 0) {
+        // Row i gets a share of the non-zeros proportional to 1 / (i + 1)
+        double harmonic = 0.0;
+        for (int i = 1; i <= n; i++) {
+            harmonic += 1.0 / i;
+        }
+        double total = density * n * n;
+        for (int i = 0; i < n; i++) {
+            long long degree = (long long)(total / ((i + 1) * harmonic)) + 1;
+            if (degree > n) degree = n;
+            for (long long k = 0; k < degree; k++) {
+                dense[(long long)i * n + nextRandom(&state) % n] = nextValue(&state);
+            }
+        }
+    } else if (strcmp(pattern, "block") == 0) {
+        // Tiles are ~90% full, so pick tiles at density / 0.9
+        int tile = 8;
+        for (int bi = 0; bi < n; bi += tile) {
+            for (int bj = 0; bj < n; bj += tile) {
+                if (nextUniform(&state) >= density / 0.9) continue;
+                for (int i = bi; i < bi + tile && i < n; i++) {
+                    for (int j = bj; j < bj + tile && j < n; j++) {
+                        if (nextUniform(&state) < 0.9) dense[(long long)i * n + j] = nextValue(&state);
+                    }
+                }
+            }
+        }
+    } else {
+        printf("Unknown pattern %s!\n", pattern);
+        return 0;
+    }
+    return 1;
+}
+
+// Everything one benchmark case operates on
+typedef struct {
+    int n;
+    int threads;
+    int* dense;
+    int* scratch;
+    SparseMatrix* sparse;
+    SparseElement* triplets;
+    SparseElement* tripletScratch;
+    int tripletSize;
+    CompressedMatrix* csr;
+    CompressedMatrix* csc;
+    BlockMatrix* bsr;
+    EncodedMatrix* enc;
+    BitmapMatrix* bitmap;
+    double* x;
+    double* y;
+} SuiteCase;
+
+// Suite operations, one per (format, operation) pair
+void opTripletConvert(SuiteCase* c) {
+    freeSparseMatrix(convertDenseToSparse(c->dense, c->n, c->n, c->n));
+}
+
+void opTripletConvertParallel(SuiteCase* c) {
+    freeSparseMatrix(convertDenseToSparseParallel(c->dense, c->n, c->n, c->n, c->threads));
+}
+
+void opTripletReconstruct(SuiteCase* c) {
+    sparseMatrixToDense(c->sparse, c->scratch, c->n);
+}
+
+void opTripletTranspose(SuiteCase* c) {
+    fastTranspose(c->triplets, c->tripletSize, c->tripletScratch);
+}
+
+void opTripletSpmv(SuiteCase* c) {
+    for (int i = 0; i < c->n; i++) {
+        c->y[i] = 0.0;
+    }
+    for (long long k = 0; k < c->sparse->count; k++) {
+        SparseEntry* e = &c->sparse->entries[k];
+        c->y[e->row] += e->value * c->x[e->col];
+    }
+}
+
+void opCsrConvert(SuiteCase* c) {
+    freeCompressed(sparseToCompressed(c->triplets, c->tripletSize, 0));
+}
+
+void opCsrReconstruct(SuiteCase* c) {
+    compressedToDense(c->csr, c->scratch, c->n);
+}
+
+void opCsrTranspose(SuiteCase* c) {
+    freeCompressed(transposeCompressed(c->csr));
+}
+
+void opCsrSpmv(SuiteCase* c) {
+    spmv(c->csr, c->x, c->y);
+}
+
+void opCscConvert(SuiteCase* c) {
+    freeCompressed(sparseToCompressed(c->triplets, c->tripletSize, 1));
+}
+
+void opCscReconstruct(SuiteCase* c) {
+    compressedToDense(c->csc, c->scratch, c->n);
+}
+
+void opCscTranspose(SuiteCase* c) {
+    freeCompressed(transposeCompressed(c->csc));
+}
+
+void opCscSpmv(SuiteCase* c) {
+    spmv(c->csc, c->x, c->y);
+}
+
+void opBsrConvert(SuiteCase* c) {
+    freeBlock(compressedToBlock(c->csr));
+}
+
+void opBsrReconstruct(SuiteCase* c) {
+    blockToDense(c->bsr, c->scratch, c->n);
+}
+
+void opBsrSpmv(SuiteCase* c) {
+    spmvBlock(c->bsr, c->x, c->y);
+}
+
+void opVarintConvert(SuiteCase* c) {
+    freeEncoded(compressedToEncoded(c->csr));
+}
+
+void opVarintReconstruct(SuiteCase* c) {
+    encodedToDense(c->enc, c->scratch, c->n);
+}
+
+void opVarintSpmv(SuiteCase* c) {
+    spmvEncoded(c->enc, c->x, c->y);
+}
+
+void opBitmapConvert(SuiteCase* c) {
+    freeBitmap(denseToBitmap(c->dense, c->n, c->n, c->n));
+}
+
+void opBitmapReconstruct(SuiteCase* c) {
+    bitmapToDense(c->bitmap, c->scratch, c->n);
+}
+
+void opBitmapSpmv(SuiteCase* c) {
+    spmvBitmap(c->bitmap, c->x, c->y);
+}
+
+typedef struct {
+    const char* format;
+    const char* operation;
+    void (*run)(SuiteCase*);
+} SuiteOp;
+
+// Time one operation: a warm-up call, then repeat for at least minSeconds
+// (and 3 calls). Returns mean seconds per call and the call count.
+double timeSuiteOp(void (*run)(SuiteCase*), SuiteCase* c, double minSeconds, int* reps) {
+    run(c);
+    
+    int count = 0;
+    double start = nowSeconds();
+    double elapsed = 0.0;
+    do {
+        run(c);
+        count++;
+        elapsed = nowSeconds() - start;
+    } while (elapsed < minSeconds || count < 3);
+    
+    *reps = count;
+    return elapsed / count;
+}
+
+// Non-interactive benchmark suite: every pattern x format x operation as
+// CSV on stdout. Transpose is timed for the triplet and CSR/CSC layouts.
+void runBenchmarkSuite(int n, double density, unsigned long long seed) {
+    const char* patterns[] = {"random", "banded", "powerlaw", "block"};
+    SuiteOp ops[] = {
+        {"triplet", "convert", opTripletConvert},
+        {"triplet", "convert_parallel", opTripletConvertParallel},
+        {"triplet", "reconstruct", opTripletReconstruct},
+        {"triplet", "transpose", opTripletTranspose},
+        {"triplet", "spmv", opTripletSpmv},
+        {"csr", "convert", opCsrConvert},
+        {"csr", "reconstruct", opCsrReconstruct},
+        {"csr", "transpose", opCsrTranspose},
+        {"csr", "spmv", opCsrSpmv},
+        {"csc", "convert", opCscConvert},
+        {"csc", "reconstruct", opCscReconstruct},
+        {"csc", "transpose", opCscTranspose},
+        {"csc", "spmv", opCscSpmv},
+        {"bsr", "convert", opBsrConvert},
+        {"bsr", "reconstruct", opBsrReconstruct},
+        {"bsr", "spmv", opBsrSpmv},
+        {"varint", "convert", opVarintConvert},
+        {"varint", "reconstruct", opVarintReconstruct},
+        {"varint", "spmv", opVarintSpmv},
+        {"bitmap", "convert", opBitmapConvert},
+        {"bitmap", "reconstruct", opBitmapReconstruct},
+        {"bitmap", "spmv", opBitmapSpmv},
+    };
+    int numOps = sizeof(ops) / sizeof(ops[0]);
+    
+    SuiteCase c;
+    c.n = n;
+    c.threads = onlineCpus() < MAX_THREADS ? onlineCpus() : MAX_THREADS;
+    c.dense = (int*)malloc((size_t)n * n * sizeof(int));
+    c.scratch = (int*)malloc((size_t)n * n * sizeof(int));
+    c.x = (double*)malloc(n * sizeof(double));
+    c.y = (double*)malloc(n * sizeof(double));
+    if (c.dense == NULL || c.scratch == NULL || c.x == NULL || c.y == NULL) {
+        printf("Out of memory for n = %d!\n", n);
+        free(c.dense);
+        free(c.scratch);
+        free(c.x);
+        free(c.y);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        c.x[i] = 1.0 + (i % 11) * 0.125;
+    }
+    
+    printf("pattern,rows,cols,nnz,format,operation,reps,seconds,mnnz_per_sec,gflops,bytes_per_nnz\n");
+    
+    for (int pt = 0; pt < 4; pt++) {
+        if (!generatePattern(patterns[pt], n, density, seed, c.dense)) continue;
+        
+        c.sparse = convertDenseToSparse(c.dense, n, n, n);
+        long long nnz = c.sparse->count;
+        if (nnz + 1 > 2147483647LL) {
+            fprintf(stderr, "Too many non-zeros for the int formats!\n");
+            freeSparseMatrix(c.sparse);
+            continue;
+        }
+        c.triplets = (SparseElement*)malloc((nnz + 1) * sizeof(SparseElement));
+        c.tripletScratch = (SparseElement*)malloc((nnz + 1) * sizeof(SparseElement));
+        c.tripletSize = sparseMatrixToTriplets(c.sparse, c.triplets, (int)nnz + 1);
+        c.csr = sparseToCompressed(c.triplets, c.tripletSize, 0);
+        c.csc = sparseToCompressed(c.triplets, c.tripletSize, 1);
+        c.bsr = compressedToBlock(c.csr);
+        c.enc = compressedToEncoded(c.csr);
+        c.bitmap = denseToBitmap(c.dense, n, n, n);
+        
+        for (int o = 0; o < numOps; o++) {
+            int reps;
+            double seconds = timeSuiteOp(ops[o].run, &c, 0.1, &reps);
+            
+            long long bytes;
+            if (strcmp(ops[o].format, "triplet") == 0) bytes = tripletBytes(nnz);
+            else if (strcmp(ops[o].format, "csr") == 0) bytes = compressedBytes(n, nnz);
+            else if (strcmp(ops[o].format, "csc") == 0) bytes = compressedBytes(n, nnz);
+            else if (strcmp(ops[o].format, "bsr") == 0) bytes = blockBytes(c.bsr);
+            else if (strcmp(ops[o].format, "varint") == 0) bytes = encodedBytes(c.enc);
+            else bytes = bitmapBytes(n, n, nnz);
+            
+            int isSpmv = strcmp(ops[o].operation, "spmv") == 0;
+            printf("%s,%d,%d,%lld,%s,%s,%d,%.9f,%.2f,%.4f,%.3f\n",
+                   patterns[pt], n, n, nnz, ops[o].format, ops[o].operation, reps, seconds,
+                   nnz / seconds * 1e-6, isSpmv ? 2.0 * nnz / seconds * 1e-9 : 0.0,
+                   nnz > 0 ? (double)bytes / nnz : 0.0);
+        }
+        
+        freeBitmap(c.bitmap);
+        freeEncoded(c.enc);
+        freeBlock(c.bsr);
+        freeCompressed(c.csc);
+        freeCompressed(c.csr);
+        free(c.tripletScratch);
+        free(c.triplets);
+        freeSparseMatrix(c.sparse);
+    }
+    
+    free(c.dense);
+    free(c.scratch);
+    free(c.x);
+    free(c.y);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        benchmarkSpmv();
+        benchmarkBlockSpmv();
+        benchmarkEncodedSpmv();
+        benchmarkMatrixMarket();
+        benchmarkConversion();
+        demoConjugateGradient();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--solve") == 0) {
+        demoConjugateGradient();
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--suite") == 0) {
+        // --suite [size] [density] [seed], CSV on stdout
+        int n = argc > 2 ? atoi(argv[2]) : 2000;
+        double density = argc > 3 ? atof(argv[3]) : 0.01;
+        unsigned long long seed = argc > 4 ? strtoull(argv[4], NULL, 10) : 1;
+        if (n < 1 || density <= 0.0 || density > 1.0) {
+            printf("Usage: %s --suite [size] [density] [seed]\n", argv[0]);
+            return 1;
+        }
+        runBenchmarkSuite(n, density, seed);
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "--load") == 0) {
+        return loadMatrixMarketCommand(argv[2]);
+    }
+    
     // Example 1: 4x5 sparse matrix
     int matrix1[10][10] = {
         {0, 0, 3, 0, 4},
@@ -130,6 +3305,160 @@ int main() {
     reconstructMatrix(sparse1, sparseSize1, reconstructed);
     displayMatrix(reconstructed, rows1, cols1);
     
+    // Compressed layouts built from the triplet form
+    CompressedMatrix* csr1 = sparseToCompressed(sparse1, sparseSize1, 0);
+    CompressedMatrix* csc1 = sparseToCompressed(sparse1, sparseSize1, 1);
+    displayCompressed(csr1);
+    displayCompressed(csc1);
+    
+    // Verify both layouts convert back to the same triplets
+    SparseElement roundTrip[MAX_TERMS];
+    int csrOk = compressedToSparse(csr1, roundTrip) == sparseSize1;
+    for (int i = 0; csrOk && i < sparseSize1; i++) {
+        csrOk = roundTrip[i].row == sparse1[i].row && roundTrip[i].col == sparse1[i].col &&
+                roundTrip[i].value == sparse1[i].value;
+    }
+    int cscOk = compressedToSparse(csc1, roundTrip) == sparseSize1;
+    for (int i = 0; cscOk && i < sparseSize1; i++) {
+        cscOk = roundTrip[i].row == sparse1[i].row && roundTrip[i].col == sparse1[i].col &&
+                roundTrip[i].value == sparse1[i].value;
+    }
+    printf("\nCSR -> triplet round trip: %s\n", csrOk ? "OK" : "MISMATCH");
+    printf("CSC -> triplet round trip: %s\n", cscOk ? "OK" : "MISMATCH");
+    
+    // Multiply by a vector of ones: each y[i] is the row sum
+    double ones[10] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+    double y1[10], y1Columns[10];
+    spmv(csr1, ones, y1);
+    spmv(csc1, ones, y1Columns);
+    printf("\nSpMV (A * ones, %s kernel): ", spmvKernelName(detectSpmvKernel()));
+    for (int i = 0; i < rows1; i++) {
+        printf("%.0f ", y1[i]);
+    }
+    printf("\nSpMV via CSC:                ");
+    for (int i = 0; i < rows1; i++) {
+        printf("%.0f ", y1Columns[i]);
+    }
+    printf("\n");
+    
+    // Same product through BSR_BLOCK x BSR_BLOCK dense tiles
+    BlockMatrix* bsr1 = sparseToBlock(sparse1, sparseSize1);
+    double y1Blocks[10];
+    spmvBlock(bsr1, ones, y1Blocks);
+    printf("SpMV via BSR (%d tiles):      ", bsr1->numBlocks);
+    for (int i = 0; i < rows1; i++) {
+        printf("%.0f ", y1Blocks[i]);
+    }
+    printf("\n");
+    freeBlock(bsr1);
+    
+    // Delta/varint encoded indices
+    EncodedMatrix* enc1 = sparseToEncoded(sparse1, sparseSize1);
+    double y1Encoded[10];
+    spmvEncoded(enc1, ones, y1Encoded);
+    printf("SpMV via varint (%lld bytes): ", encodedBytes(enc1));
+    for (int i = 0; i < rows1; i++) {
+        printf("%.0f ", y1Encoded[i]);
+    }
+    printf("\n");
+    
+    // Save and load the encoded form again through a temporary file
+    char encPath[] = "/tmp/sparse_enc_XXXXXX";
+    int encFd = mkstemp(encPath);
+    int encOk = 0;
+    if (encFd >= 0) {
+        close(encFd);
+        EncodedMatrix* loaded1 = saveEncoded(encPath, enc1) ? loadEncoded(encPath) : NULL;
+        encOk = loaded1 != NULL && loaded1->rows == enc1->rows && loaded1->cols == enc1->cols &&
+                loaded1->count == enc1->count && loaded1->numBytes == enc1->numBytes &&
+                memcmp(loaded1->bytes, enc1->bytes, enc1->numBytes) == 0 &&
+                memcmp(loaded1->values, enc1->values, enc1->count * sizeof(int)) == 0;
+        freeEncoded(loaded1);
+        remove(encPath);
+    }
+    printf("Varint save/load round trip: %s\n", encOk ? "OK" : "MISMATCH");
+    freeEncoded(enc1);
+    freeCompressed(csr1);
+    freeCompressed(csc1);
+    
+    // Transpose and A * A^T without going through the dense form
+    SparseElement transposed1[MAX_TERMS];
+    int transposedSize1 = fastTranspose(sparse1, sparseSize1, transposed1);
+    printf("\n--- Fast Transpose ---");
+    displaySparse(transposed1, transposedSize1);
+    
+    SparseElement product1[MAX_TERMS];
+    int productSize1 = multiplySparse(sparse1, sparseSize1, transposed1, transposedSize1,
+                                      product1, MAX_TERMS);
+    printf("\n--- Sparse Product A * A^T ---");
+    displaySparse(product1, productSize1);
+    
+    // Check against the dense product
+    int productOk = 1;
+    int productDense[10][10];
+    reconstructMatrix(product1, productSize1, productDense);
+    for (int i = 0; i < rows1; i++) {
+        for (int j = 0; j < rows1; j++) {
+            int expected = 0;
+            for (int t = 0; t < cols1; t++) {
+                expected += matrix1[i][t] * matrix1[j][t];
+            }
+            if (productDense[i][j] != expected) productOk = 0;
+        }
+    }
+    printf("Sparse product matches dense product: %s\n", productOk ? "OK" : "MISMATCH");
+    
+    // Element-wise operations by merging sorted terms
+    int other1[10][10] = {
+        {1, 0, -3, 0, 0},
+        {0, 0, 0, 2, 0},
+        {0, 9, 0, 0, 0},
+        {0, 0, 6, 0, 1}
+    };
+    SparseElement sparseOther1[MAX_TERMS];
+    int otherSize1 = convertToSparse(other1, rows1, cols1, sparseOther1);
+    
+    // Reverse B's terms so the merge has to radix-sort them first
+    for (int i = 1, j = otherSize1 - 1; i < j; i++, j--) {
+        SparseElement temp = sparseOther1[i];
+        sparseOther1[i] = sparseOther1[j];
+        sparseOther1[j] = temp;
+    }
+    
+    SparseElement merged1[MAX_TERMS];
+    int mergedSize1 = addSparse(sparse1, sparseSize1, sparseOther1, otherSize1, merged1, MAX_TERMS);
+    printf("\n--- Element-wise A + B (B entered unsorted, zeros dropped) ---");
+    displaySparse(merged1, mergedSize1);
+    mergedSize1 = subtractSparse(sparse1, sparseSize1, sparseOther1, otherSize1, merged1, MAX_TERMS);
+    printf("\n--- Element-wise A - B ---");
+    displaySparse(merged1, mergedSize1);
+    mergedSize1 = hadamardSparse(sparse1, sparseSize1, sparseOther1, otherSize1, merged1, MAX_TERMS);
+    printf("\n--- Hadamard A .* B ---");
+    displaySparse(merged1, mergedSize1);
+    
+    // Random-order updates with duplicates, accumulated in a hash table
+    SparseBuilder* builder = createBuilder(rows1, cols1, 4);
+    builderAdd(builder, 3, 2, 4);
+    builderAdd(builder, 0, 4, 4);
+    builderAdd(builder, 1, 3, 7);
+    builderAdd(builder, 0, 2, 3);
+    builderAdd(builder, 3, 1, 2);
+    builderAdd(builder, 2, 0, 5);   // Cancelled below
+    builderAdd(builder, 1, 2, 5);
+    builderAdd(builder, 3, 2, 2);   // 4 + 2 = 6
+    builderAdd(builder, 2, 0, -5);
+    
+    SparseElement built1[MAX_TERMS];
+    int builtSize1 = finalizeBuilder(builder, built1, MAX_TERMS);
+    int builtOk = builtSize1 == sparseSize1;
+    for (int i = 0; builtOk && i < sparseSize1; i++) {
+        builtOk = built1[i].row == sparse1[i].row && built1[i].col == sparse1[i].col &&
+                  built1[i].value == sparse1[i].value;
+    }
+    printf("\nHash builder (9 updates, random order) matches example 1: %s\n",
+           builtOk ? "OK" : "MISMATCH");
+    freeBuilder(builder);
+    
     // Example 2: More sparse matrix (6x6)
     printf("\n\n═══════════════════════════════════════════════\n");
     printf("   SPARSE MATRIX CONVERSION - EXAMPLE 2\n");
@@ -158,51 +3487,81 @@ int main() {
     printf("═══════════════════════════════════════════════\n");
     
     int customRows, customCols;
-    int customMatrix[10][10];
     
-    printf("\nEnter number of rows (max 10): ");
+    printf("\nEnter number of rows: ");
     scanf("%d", &customRows);
-    printf("Enter number of columns (max 10): ");
+    printf("Enter number of columns: ");
     scanf("%d", &customCols);
     
-    if (customRows > 10 || customCols > 10 || customRows < 1 || customCols < 1) {
+    if (customRows < 1 || customCols < 1) {
         printf("Invalid dimensions!\n");
         return 1;
     }
     
+    int* customMatrix = (int*)malloc((long long)customRows * customCols * sizeof(int));
+    if (customMatrix == NULL) {
+        printf("Out of memory!\n");
+        return 1;
+    }
+    
     printf("\nEnter matrix elements (row by row):\n");
     for (int i = 0; i < customRows; i++) {
         for (int j = 0; j < customCols; j++) {
             printf("Element [%d][%d]: ", i, j);
-            scanf("%d", &customMatrix[i][j]);
+            scanf("%d", &customMatrix[(long long)i * customCols + j]);
         }
     }
     
-    SparseElement customSparse[MAX_TERMS];
-    int customSparseSize = convertToSparse(customMatrix, customRows, customCols, customSparse);
+    SparseMatrix* customSparse = convertDenseToSparse(customMatrix, customRows, customCols, customCols);
+    if (customSparse == NULL) {
+        free(customMatrix);
+        return 1;
+    }
     
-    displayMatrix(customMatrix, customRows, customCols);
-    displaySparse(customSparse, customSparseSize);
-    calculateSavings(customRows, customCols, customSparse[0].value);
+    displayDense(customMatrix, customRows, customCols, customCols);
+    displaySparseMatrix(customSparse);
+    calculateSavings(customRows, customCols, customSparse->count);
     
     // Sparsity analysis
-    int totalElements = customRows * customCols;
-    int nonZeroElements = customSparse[0].value;
+    long long totalElements = (long long)customRows * customCols;
+    long long nonZeroElements = customSparse->count;
     float sparsityRatio = ((float)(totalElements - nonZeroElements) / totalElements) * 100;
     
     printf("\n=== Sparsity Analysis ===\n");
-    printf("Total elements: %d\n", totalElements);
-    printf("Non-zero elements: %d\n", nonZeroElements);
-    printf("Zero elements: %d\n", totalElements - nonZeroElements);
+    printf("Total elements: %lld\n", totalElements);
+    printf("Non-zero elements: %lld\n", nonZeroElements);
+    printf("Zero elements: %lld\n", totalElements - nonZeroElements);
     printf("Sparsity ratio: %.2f%% (percentage of zeros)\n", sparsityRatio);
     
     if (sparsityRatio > 70) {
         printf("✓ This is a highly sparse matrix - sparse representation is very beneficial!\n");
     } else if (sparsityRatio > 40) {
         printf("✓ This is a moderately sparse matrix - sparse representation is beneficial.\n");
+        if (bitmapBytes(customRows, customCols, nonZeroElements) <
+            compressedBytes(customRows, nonZeroElements)) {
+            printf("  The bitmap layout is the smallest sparse form at this density.\n");
+        }
     } else {
         printf("⚠ This matrix is not very sparse - sparse representation may not save much space.\n");
     }
     
+    // Bitmap layout round trip
+    BitmapMatrix* customBitmap = denseToBitmap(customMatrix, customRows, customCols, customCols);
+    int* customRoundTrip = (int*)malloc((long long)customRows * customCols * sizeof(int));
+    bitmapToDense(customBitmap, customRoundTrip, customCols);
+    int bitmapOk = memcmp(customRoundTrip, customMatrix, (long long)customRows * customCols * sizeof(int)) == 0;
+    for (int i = 0; bitmapOk && i < customRows; i++) {
+        for (int j = 0; bitmapOk && j < customCols; j++) {
+            bitmapOk = bitmapGet(customBitmap, i, j) == customMatrix[(long long)i * customCols + j];
+        }
+    }
+    printf("\nBitmap layout: %lld bytes, round trip and random access %s\n",
+           bitmapBytes(customRows, customCols, customBitmap->nnz), bitmapOk ? "OK" : "MISMATCH");
+    free(customRoundTrip);
+    freeBitmap(customBitmap);
+    
+    freeSparseMatrix(customSparse);
+    free(customMatrix);
+    
     return 0;
 }
@@ -1,191 +1,1579 @@
+// Build: gcc -O2 -pthread 2_tower_of_hanoi.c -o tower_of_hanoi
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+
+// Worker thread limit for parallel move generation
+#define MAX_THREADS 64
+
+// Compact move: source peg in bits 2-3, destination peg in bits 0-1
+#define PACK_MOVE(from, to) ((unsigned char)(((from) << 2) | (to)))
+#define MOVE_FROM(code) (((code) >> 2) & 3)
+#define MOVE_TO(code) ((code) & 3)
+
+// Move stream buffer size; flushed with one write(2) when full
+#define WRITE_BUFFER (1 << 20)
+
+// Largest puzzle: one bit per disk in a 64-bit peg mask
+#define MAX_DISKS 64
 
 // Global counter for moves
-int moveCount = 0;
+unsigned long long moveCount = 0;
+
+// Most pegs supported by the Frame-Stewart solver
+#define MAX_PEGS 8
+
+// Peg names (pegs are numbered from 0; the classic puzzle uses A-C)
+const char PEG_NAMES[] = "ABCDEFGH";
 
-// Structure to represent a disk
+// One move of the optimal sequence
 typedef struct {
-    int size;
-} Disk;
+    unsigned long long index;  // 1-based move number
+    int disk;                  // 1 = smallest
+    int from;                  // Peg 0-2
+    int to;
+} HanoiMove;
 
-// Structure to represent a tower/peg
+// Iterator over the 2^n - 1 moves taking all disks from peg A to peg C
 typedef struct {
-    Disk disks[100];
-    int top;
+    int n;
+    unsigned long long next;   // Next move number
+    unsigned long long total;
+    unsigned char peg[65];     // Current peg of each disk (1-based)
+    unsigned char step[65];    // 1 (A->B->C) or 2 (A->C->B) per disk
+} HanoiIterator;
+
+// Receives each move produced by solveHanoiIterative
+typedef void (*HanoiCallback)(const HanoiMove* move, void* context);
+
+// Structure to represent a tower/peg.
+// Bit d-1 is set when disk d is on the peg. Disks on a peg are always
+// stacked largest at the bottom, so the set alone fixes their order and
+// the top disk is the lowest set bit.
+typedef struct {
+    unsigned long long disks;
     char name;
 } Tower;
 
 // Initialize tower
 void initTower(Tower* tower, char name) {
-    tower->top = -1;
+    tower->disks = 0;
     tower->name = name;
 }
 
+// Size of the top disk, or 0 if the tower is empty
+static inline int topDisk(const Tower* tower) {
+    return tower->disks ? __builtin_ctzll(tower->disks) + 1 : 0;
+}
+
+// Number of disks on the tower
+static inline int diskCount(const Tower* tower) {
+    return __builtin_popcountll(tower->disks);
+}
+
 // Push disk onto tower
 void push(Tower* tower, int size) {
-    if (tower->top < 99) {
-        tower->top++;
-        tower->disks[tower->top].size = size;
+    if (size >= 1 && size <= MAX_DISKS) {
+        tower->disks |= 1ULL << (size - 1);
     }
 }
 
 // Pop disk from tower
 int pop(Tower* tower) {
-    if (tower->top >= 0) {
-        int size = tower->disks[tower->top].size;
-        tower->top--;
+    if (tower->disks) {
+        int size = __builtin_ctzll(tower->disks) + 1;
+        tower->disks &= tower->disks - 1;
         return size;
     }
     return -1;
 }
 
+// Size of the disk at a level counted from the bottom (0), or 0 if none
+int diskAtLevel(const Tower* tower, int level) {
+    int count = diskCount(tower);
+    if (level >= count) return 0;
+    
+    // Drop the smaller disks stacked above this level
+    unsigned long long rest = tower->disks;
+    for (int i = 0; i < count - 1 - level; i++) {
+        rest &= rest - 1;
+    }
+    return __builtin_ctzll(rest) + 1;
+}
+
+// Frame layout: separator, one row per level, base, labels, separator,
+// and a status line when animating
+#define MAX_VISUAL_DISKS 20
+#define MAX_FRAME_ROWS (MAX_VISUAL_DISKS + 5)
+#define FRAME_ROW_BYTES 512
+
+// Animation frame budgets
+#define FRAME_SLOW_NS 500000000L
+#define FRAME_FAST_NS 150000000L
+
+typedef struct {
+    char rows[MAX_FRAME_ROWS][FRAME_ROW_BYTES];
+    int length[MAX_FRAME_ROWS];
+    int count;
+} Frame;
+
+// Append count copies of text to a row
+static inline void appendRepeat(char* row, int* length, const char* text, int count) {
+    int size = (int)strlen(text);
+    for (int i = 0; i < count; i++) {
+        memcpy(row + *length, text, (size_t)size);
+        *length += size;
+    }
+}
+
+// Render the towers (left to right in the given order) into frame rows
+void renderFrame(Frame* frame, Tower* towers[3], int n, const char* status) {
+    const char* separator = "════════════════════════════════════════════════════════";
+    int row = 0;
+    
+    frame->length[row] = 0;
+    appendRepeat(frame->rows[row], &frame->length[row], separator, 1);
+    row++;
+    
+    // Print from top to bottom
+    for (int level = n - 1; level >= 0; level--, row++) {
+        char* out = frame->rows[row];
+        int* length = &frame->length[row];
+        *length = 0;
+        appendRepeat(out, length, " ", 2);
+        
+        for (int t = 0; t < 3; t++) {
+            if (t > 0) appendRepeat(out, length, " ", 3);
+            int size = diskAtLevel(towers[t], level);
+            if (size > 0) {
+                appendRepeat(out, length, " ", n - size);
+                appendRepeat(out, length, "█", size * 2 - 1);
+                appendRepeat(out, length, " ", n - size);
+            } else {
+                appendRepeat(out, length, " ", n - 1);
+                appendRepeat(out, length, "│", 1);
+                appendRepeat(out, length, " ", n - 1);
+            }
+        }
+    }
+    
+    // Base
+    frame->length[row] = 0;
+    appendRepeat(frame->rows[row], &frame->length[row], " ", 2);
+    for (int t = 0; t < 3; t++) {
+        if (t > 0) appendRepeat(frame->rows[row], &frame->length[row], " ", 3);
+        appendRepeat(frame->rows[row], &frame->length[row], "═", n * 2 - 1);
+    }
+    row++;
+    
+    // Tower labels
+    frame->length[row] = 0;
+    appendRepeat(frame->rows[row], &frame->length[row], " ", 2);
+    for (int t = 0; t < 3; t++) {
+        char name[2] = {towers[t]->name, '\0'};
+        if (t > 0) appendRepeat(frame->rows[row], &frame->length[row], " ", 3);
+        appendRepeat(frame->rows[row], &frame->length[row], " ", n - 1);
+        appendRepeat(frame->rows[row], &frame->length[row], name, 1);
+        appendRepeat(frame->rows[row], &frame->length[row], " ", n - 1);
+    }
+    row++;
+    
+    frame->length[row] = 0;
+    appendRepeat(frame->rows[row], &frame->length[row], separator, 1);
+    row++;
+    
+    if (status != NULL) {
+        frame->length[row] = snprintf(frame->rows[row], FRAME_ROW_BYTES, "%s", status);
+        row++;
+    }
+    frame->count = row;
+}
+
 // Display all three towers
 void displayTowers(Tower* source, Tower* auxiliary, Tower* destination, int n) {
-    printf("\n");
-    printf("════════════════════════════════════════════════════════\n");
+    Tower* towers[3] = {source, auxiliary, destination};
+    static Frame frame;
+    static char buffer[MAX_FRAME_ROWS * (FRAME_ROW_BYTES + 1) + 1];
     
-    // Print from top to bottom
-    for (int level = n - 1; level >= 0; level--) {
-        // Tower A
-        printf("  ");
-        if (level <= source->top) {
-            int size = source->disks[level].size;
-            for (int i = 0; i < n - size; i++) printf(" ");
-            for (int i = 0; i < size * 2 - 1; i++) printf("█");
-            for (int i = 0; i < n - size; i++) printf(" ");
-        } else {
-            for (int i = 0; i < n - 1; i++) printf(" ");
-            printf("│");
-            for (int i = 0; i < n - 1; i++) printf(" ");
+    if (n > MAX_VISUAL_DISKS) {
+        printf("Too many disks to draw!\n");
+        return;
+    }
+    renderFrame(&frame, towers, n, NULL);
+    
+    // Whole frame in one write
+    size_t used = 0;
+    buffer[used++] = '\n';
+    for (int r = 0; r < frame.count; r++) {
+        memcpy(buffer + used, frame.rows[r], (size_t)frame.length[r]);
+        used += (size_t)frame.length[r];
+        buffer[used++] = '\n';
+    }
+    fwrite(buffer, 1, used, stdout);
+}
+
+// In-place animation: pegs stay in A, B, C order, frames are paced by an
+// absolute-deadline timer, and only rows that changed since the last frame
+// are rewritten (cursor moved up to the row and back with ANSI escapes)
+typedef struct {
+    Tower* towers[3];
+    int n;
+    Frame previous;
+    int drawn;
+    long frameNanos;
+    struct timespec nextFrame;
+} Animation;
+
+Animation animation;
+
+// Move the next frame slot one frame period later
+void advanceFrameDeadline() {
+    animation.nextFrame.tv_nsec += animation.frameNanos;
+    while (animation.nextFrame.tv_nsec >= 1000000000L) {
+        animation.nextFrame.tv_nsec -= 1000000000L;
+        animation.nextFrame.tv_sec++;
+    }
+}
+
+// The first frame is due one period from now, so the opening frame is held
+// as long as every other one
+void startAnimation(Tower* a, Tower* b, Tower* c, int n, int delay) {
+    animation.towers[0] = a;
+    animation.towers[1] = b;
+    animation.towers[2] = c;
+    animation.n = n;
+    animation.drawn = 0;
+    animation.frameNanos = delay == 1 ? FRAME_SLOW_NS : FRAME_FAST_NS;
+    clock_gettime(CLOCK_MONOTONIC, &animation.nextFrame);
+    advanceFrameDeadline();
+}
+
+// Sleep until the next frame slot. If drawing fell behind, restart the
+// schedule from now instead of rushing through the missed frames.
+void waitNextFrame() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > animation.nextFrame.tv_sec ||
+        (now.tv_sec == animation.nextFrame.tv_sec && now.tv_nsec > animation.nextFrame.tv_nsec)) {
+        animation.nextFrame = now;
+    } else {
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &animation.nextFrame, NULL) == EINTR);
+    }
+    
+    advanceFrameDeadline();
+}
+
+// Draw the current state with a status line, redrawing only changed rows
+void animateFrame(const char* status) {
+    static Frame frame;
+    static char buffer[MAX_FRAME_ROWS * (FRAME_ROW_BYTES + 32) + 1];
+    size_t used = 0;
+    
+    renderFrame(&frame, animation.towers, animation.n, status);
+    if (animation.drawn) waitNextFrame();
+    
+    for (int r = 0; r < frame.count; r++) {
+        if (!animation.drawn) {
+            memcpy(buffer + used, frame.rows[r], (size_t)frame.length[r]);
+            used += (size_t)frame.length[r];
+            buffer[used++] = '\n';
+            continue;
+        }
+        if (frame.length[r] == animation.previous.length[r] &&
+            memcmp(frame.rows[r], animation.previous.rows[r], (size_t)frame.length[r]) == 0) {
+            continue;
         }
         
-        printf("   ");
-        
-        // Tower B
-        if (level <= auxiliary->top) {
-            int size = auxiliary->disks[level].size;
-            for (int i = 0; i < n - size; i++) printf(" ");
-            for (int i = 0; i < size * 2 - 1; i++) printf("█");
-            for (int i = 0; i < n - size; i++) printf(" ");
+        // Cursor rests on the line below the frame
+        int up = frame.count - r;
+        used += (size_t)sprintf(buffer + used, "\033[%dA\r", up);
+        memcpy(buffer + used, frame.rows[r], (size_t)frame.length[r]);
+        used += (size_t)frame.length[r];
+        used += (size_t)sprintf(buffer + used, "\033[K\033[%dB\r", up);
+    }
+    
+    fwrite(buffer, 1, used, stdout);
+    fflush(stdout);
+    animation.previous = frame;
+    animation.drawn = 1;
+}
+
+// Output mode of a move stream
+#define STREAM_BINARY 0  // One PACK_MOVE byte per move
+#define STREAM_TEXT 1    // "Move K: Move disk D from X to Y" lines
+
+// Buffered writer on a file descriptor, bypassing stdio
+typedef struct {
+    int fd;
+    int mode;
+    unsigned char* buffer;
+    size_t used;
+    size_t capacity;
+    unsigned long long bytesWritten;
+    int failed;
+} MoveWriter;
+
+// write(2) all of data, retrying short writes. Returns the bytes written.
+size_t writeAll(int fd, const void* data, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t written = write(fd, (const char*)data + done, size - done);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        done += (size_t)written;
+    }
+    return done;
+}
+
+// Write out the buffer. Returns 0 or -1.
+int flushMoveWriter(MoveWriter* writer) {
+    size_t done = writeAll(writer->fd, writer->buffer, writer->used);
+    if (done < writer->used) writer->failed = 1;
+    writer->bytesWritten += done;
+    writer->used = 0;
+    return writer->failed ? -1 : 0;
+}
+
+// Returns 0 on success, -1 if the buffer cannot be allocated
+int initMoveWriter(MoveWriter* writer, int fd, int mode) {
+    writer->fd = fd;
+    writer->mode = mode;
+    writer->used = 0;
+    writer->capacity = WRITE_BUFFER;
+    writer->bytesWritten = 0;
+    writer->failed = 0;
+    writer->buffer = (unsigned char*)malloc(WRITE_BUFFER);
+    if (writer->buffer == NULL) {
+        printf("Memory allocation failed!\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Flush and release the buffer (the descriptor stays open)
+int closeMoveWriter(MoveWriter* writer) {
+    int result = flushMoveWriter(writer);
+    free(writer->buffer);
+    writer->buffer = NULL;
+    return result;
+}
+
+// Decimal digits of value into out (no terminator). Returns the length.
+static inline int formatUnsigned(char* out, unsigned long long value) {
+    char digits[20];
+    int length = 0;
+    do {
+        digits[length++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    for (int i = 0; i < length; i++) {
+        out[i] = digits[length - 1 - i];
+    }
+    return length;
+}
+
+// Longest text line is about 60 bytes
+#define MAX_MOVE_LINE 64
+
+// Format "Move K: Move disk D from X to Y\n" into out. Returns the length.
+static inline int formatMoveLine(char* out, unsigned long long index, int disk, int from, int to) {
+    char* start = out;
+    memcpy(out, "Move ", 5);
+    out += 5;
+    out += formatUnsigned(out, index);
+    memcpy(out, ": Move disk ", 12);
+    out += 12;
+    out += formatUnsigned(out, (unsigned long long)disk);
+    memcpy(out, " from ", 6);
+    out += 6;
+    *out++ = PEG_NAMES[from];
+    memcpy(out, " to ", 4);
+    out += 4;
+    *out++ = PEG_NAMES[to];
+    *out++ = '\n';
+    return (int)(out - start);
+}
+
+// Append one move in the writer's mode
+static inline void writeMove(MoveWriter* writer, unsigned long long index, int disk, int from, int to) {
+    if (writer->mode == STREAM_BINARY) {
+        writer->buffer[writer->used++] = PACK_MOVE(from, to);
+        if (writer->used == writer->capacity) flushMoveWriter(writer);
+        return;
+    }
+    
+    if (writer->capacity - writer->used < MAX_MOVE_LINE) flushMoveWriter(writer);
+    writer->used += (size_t)formatMoveLine((char*)writer->buffer + writer->used, index, disk, from, to);
+}
+
+// Recursive solution streamed through a MoveWriter (pegs are 0-2)
+void towerOfHanoiStream(int n, int source, int destination, int auxiliary, MoveWriter* writer) {
+    if (n == 1) {
+        moveCount++;
+        writeMove(writer, moveCount, 1, source, destination);
+        return;
+    }
+    
+    towerOfHanoiStream(n - 1, source, auxiliary, destination, writer);
+    moveCount++;
+    writeMove(writer, moveCount, n, source, destination);
+    towerOfHanoiStream(n - 1, auxiliary, destination, source, writer);
+}
+
+// Make one move; animated moves are shown in the frame's status line
+void visualMove(Tower* source, Tower* destination, int delay) {
+    moveCount++;
+    int disk = pop(source);
+    push(destination, disk);
+    
+    if (delay > 0) {
+        char status[FRAME_ROW_BYTES];
+        snprintf(status, sizeof(status), ">>> Move %llu: Move disk %d from %c to %c",
+                 moveCount, disk, source->name, destination->name);
+        animateFrame(status);
+    } else {
+        printf("\n>>> Move %llu: Move disk %d from %c to %c\n",
+               moveCount, disk, source->name, destination->name);
+    }
+}
+
+// Advanced Tower of Hanoi with visualization
+void towerOfHanoiVisual(int n, Tower* source, Tower* auxiliary, Tower* destination, int delay) {
+    if (n == 1) {
+        visualMove(source, destination, delay);
+        return;
+    }
+    
+    // Move n-1 disks from source to auxiliary using destination
+    towerOfHanoiVisual(n - 1, source, destination, auxiliary, delay);
+    
+    // Move the largest disk
+    visualMove(source, destination, delay);
+    
+    // Move n-1 disks from auxiliary to destination using source
+    towerOfHanoiVisual(n - 1, auxiliary, source, destination, delay);
+}
+
+// Calculate total moves (2^n - 1); exact up to n = 64
+unsigned long long calculateMoves(int n) {
+    if (n >= 64) return ~0ULL;
+    return (1ULL << n) - 1;
+}
+
+// Iterative engine: move k from the bits of k, no recursion.
+// The lowest set bit of k picks the disk d; k >> d is how many times that
+// disk has moved before. Disk d cycles A->C->B when n - d is even and
+// A->B->C when it is odd, so its pegs follow from that count mod 3.
+static inline int diskStep(int n, int disk) {
+    return ((n - disk) & 1) ? 1 : 2;
+}
+
+static inline void hanoiMoveAt(int n, unsigned long long k, HanoiMove* move) {
+    int disk = __builtin_ctzll(k) + 1;
+    unsigned long long previous = disk < 64 ? k >> disk : 0;
+    int step = diskStep(n, disk);
+    int from = (int)((previous % 3) * step % 3);
+    
+    move->index = k;
+    move->disk = disk;
+    move->from = from;
+    move->to = (from + step) % 3;
+}
+
+// Peg of every disk just before move number first. Disk d has moved
+// (first - 1 + 2^(d-1)) >> d times by then.
+void diskPegsBefore(int n, unsigned long long first, unsigned char peg[], unsigned char step[]) {
+    for (int d = 1; d <= n; d++) {
+        unsigned long long moved = (d < 64 ? (first - 1) >> d : 0) + (((first - 1) >> (d - 1)) & 1);
+        step[d] = (unsigned char)diskStep(n, d);
+        peg[d] = (unsigned char)((moved % 3) * step[d] % 3);
+    }
+}
+
+// Disk-to-peg assignment after the first k moves, in O(n).
+// peg[d] receives the peg (0-2) of disk d for d = 1..n.
+void hanoiStateAfter(int n, unsigned long long k, unsigned char peg[]) {
+    unsigned char step[65];
+    diskPegsBefore(n, k + 1, peg, step);
+}
+
+// Inverse of hanoiStateAfter: how many moves of the optimal A->C sequence
+// produce this assignment. Walks from the largest disk down: a disk still on
+// the subproblem's source contributes nothing, a disk already on its target
+// contributes 2^(d-1) moves, and a disk on the spare peg means the state is
+// not on the optimal path. Returns 1 and sets *k, or 0 for such states.
+int hanoiMoveIndex(int n, const unsigned char peg[], unsigned long long* k) {
+    int source = 0, target = 2, spare = 1;
+    unsigned long long moves = 0;
+    
+    for (int d = n; d >= 1; d--) {
+        if (peg[d] == source) {
+            // Disks above still have to go source -> spare
+            int temp = target;
+            target = spare;
+            spare = temp;
+        } else if (peg[d] == target) {
+            // Disks above already went source -> spare and now go spare -> target
+            moves += 1ULL << (d - 1);
+            int temp = source;
+            source = spare;
+            spare = temp;
         } else {
-            for (int i = 0; i < n - 1; i++) printf(" ");
-            printf("│");
-            for (int i = 0; i < n - 1; i++) printf(" ");
+            return 0;
+        }
+    }
+    
+    *k = moves;
+    return 1;
+}
+
+// Reposition an iterator so its next move is movesDone + 1
+void seekHanoiIterator(HanoiIterator* it, unsigned long long movesDone) {
+    it->next = movesDone + 1;
+    diskPegsBefore(it->n, it->next, it->peg, it->step);
+}
+
+// Start an iterator at move 1
+void initHanoiIterator(HanoiIterator* it, int n) {
+    it->n = n;
+    it->next = 1;
+    it->total = calculateMoves(n);
+    diskPegsBefore(n, 1, it->peg, it->step);
+}
+
+// Produce the next move. Returns 1, or 0 once all moves are done.
+// Each disk's peg is tracked, so a move costs a bit scan and an add.
+static inline int hanoiNext(HanoiIterator* it, HanoiMove* move) {
+    if (it->next - 1 >= it->total) return 0;  // Also stops when next wraps at n = 64
+    
+    int disk = __builtin_ctzll(it->next) + 1;
+    int from = it->peg[disk];
+    int to = from + it->step[disk];
+    if (to >= 3) to -= 3;
+    it->peg[disk] = (unsigned char)to;
+    
+    move->index = it->next++;
+    move->disk = disk;
+    move->from = from;
+    move->to = to;
+    return 1;
+}
+
+// Fill out[] with up to count moves starting at move number first.
+// Returns the number of moves written.
+int hanoiFillMoves(int n, unsigned long long first, HanoiMove* out, int count) {
+    HanoiIterator it;
+    int written = 0;
+    
+    initHanoiIterator(&it, n);
+    seekHanoiIterator(&it, first - 1);
+    while (written < count && hanoiNext(&it, &out[written])) {
+        written++;
+    }
+    return written;
+}
+
+// Run the whole sequence through a callback. Returns the number of moves.
+unsigned long long solveHanoiIterative(int n, HanoiCallback callback, void* context) {
+    HanoiIterator it;
+    HanoiMove move;
+    
+    initHanoiIterator(&it, n);
+    while (hanoiNext(&it, &move)) {
+        callback(&move, context);
+    }
+    return it.total;
+}
+
+// Callback that replays moves on real towers and checks each one is legal
+typedef struct {
+    Tower* pegs[MAX_PEGS];
+    int illegal;
+} ReplayContext;
+
+void replayMove(const HanoiMove* move, void* context) {
+    ReplayContext* replay = (ReplayContext*)context;
+    Tower* from = replay->pegs[move->from];
+    Tower* to = replay->pegs[move->to];
+    
+    if (topDisk(from) != move->disk || (to->disks && topDisk(to) < move->disk)) {
+        replay->illegal++;
+    }
+    push(to, pop(from));
+}
+
+// Callback that folds moves into a checksum so nothing is optimized away
+void checksumMove(const HanoiMove* move, void* context) {
+    unsigned long long* sum = (unsigned long long*)context;
+    *sum = *sum * 31 + (unsigned long long)(move->disk * 9 + move->from * 3 + move->to);
+}
+
+// Monotonic wall clock in nanoseconds
+unsigned long long nowNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+// Monotonic wall clock in seconds
+double nowSeconds() {
+    return nowNanos() * 1e-9;
+}
+
+// Events per second, or 0 when the interval is too short to measure
+double perSecond(unsigned long long count, double seconds) {
+    return seconds > 0 ? count / seconds : 0;
+}
+
+// Verify the iterative engine on real towers, then measure its speed
+void runIterativeBenchmark(int n) {
+    // Replay check (bounded so it stays quick)
+    int checkDisks = n < 20 ? n : 20;
+    Tower towerA, towerB, towerC;
+    initTower(&towerA, 'A');
+    initTower(&towerB, 'B');
+    initTower(&towerC, 'C');
+    for (int i = checkDisks; i >= 1; i--) {
+        push(&towerA, i);
+    }
+    
+    ReplayContext replay = {{&towerA, &towerB, &towerC}, 0};
+    solveHanoiIterative(checkDisks, replayMove, &replay);
+    int solved = replay.illegal == 0 && diskCount(&towerC) == checkDisks;
+    
+    // The incremental iterator must agree with the closed form for move k
+    HanoiIterator it;
+    HanoiMove move, direct;
+    initHanoiIterator(&it, checkDisks);
+    while (solved && hanoiNext(&it, &move)) {
+        hanoiMoveAt(checkDisks, move.index, &direct);
+        solved = direct.disk == move.disk && direct.from == move.from && direct.to == move.to;
+    }
+    printf("Replay check (%d disks): %s\n", checkDisks,
+           solved ? "all moves legal, all disks on C" : "FAILED");
+    
+    // Callback API
+    unsigned long long checksum = 0;
+    double start = nowSeconds();
+    unsigned long long total = solveHanoiIterative(n, checksumMove, &checksum);
+    double callbackTime = nowSeconds() - start;
+    
+    // Batch API into a reused buffer
+    HanoiMove batch[4096];
+    unsigned long long batchSum = 0;
+    start = nowSeconds();
+    for (unsigned long long k = 1; k <= total; k += 4096) {
+        int count = hanoiFillMoves(n, k, batch, 4096);
+        for (int i = 0; i < count; i++) {
+            batchSum += batch[i].disk + batch[i].to;
+        }
+    }
+    double batchTime = nowSeconds() - start;
+    
+    printf("\nTotal moves:       %llu\n", total);
+    printf("Callback API:      %.4f seconds, %.0f moves/second (checksum %llx)\n",
+           callbackTime, perSecond(total, callbackTime), checksum);
+    printf("Batch API:         %.4f seconds, %.0f moves/second (checksum %llx)\n",
+           batchTime, perSecond(total, batchTime), batchSum);
+}
+
+// Jump straight to move k, show the towers and check the inverse
+void runJumpToMove(int n, unsigned long long k) {
+    unsigned char peg[65];
+    unsigned long long back;
+    
+    hanoiStateAfter(n, k, peg);
+    printf("State after move %llu of %llu:\n", k, calculateMoves(n));
+    for (int p = 0; p < 3; p++) {
+        printf("  %c: ", PEG_NAMES[p]);
+        for (int d = n; d >= 1; d--) {
+            if (peg[d] == p) printf("%d ", d);
+        }
+        printf("\n");
+    }
+    
+    if (hanoiMoveIndex(n, peg, &back)) {
+        printf("Inverse (state -> move index): %llu %s\n", back, back == k ? "✓" : "✗");
+    } else {
+        printf("Inverse: state is not on the optimal path ✗\n");
+    }
+    
+    // Next few moves from this checkpoint, without replaying the prefix
+    HanoiMove upcoming[5];
+    int count = hanoiFillMoves(n, k + 1, upcoming, 5);
+    for (int i = 0; i < count; i++) {
+        printf("  Move %llu: disk %d from %c to %c\n", upcoming[i].index, upcoming[i].disk,
+               PEG_NAMES[upcoming[i].from], PEG_NAMES[upcoming[i].to]);
+    }
+}
+
+// Stream the full solution to a file and report throughput
+void runStreamOutput(int n, int mode, const char* path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        printf("Cannot open %s!\n", path);
+        return;
+    }
+    
+    MoveWriter writer;
+    if (initMoveWriter(&writer, fd, mode) != 0) {
+        close(fd);
+        return;
+    }
+    
+    moveCount = 0;
+    double start = nowSeconds();
+    towerOfHanoiStream(n, 0, 2, 1, &writer);
+    int result = closeMoveWriter(&writer);
+    double timeTaken = nowSeconds() - start;
+    close(fd);
+    
+    if (result != 0) {
+        printf("Write to %s failed!\n", path);
+        return;
+    }
+    printf("Format:            %s\n", mode == STREAM_BINARY ? "binary ((from<<2)|to, 1 byte/move)" : "text");
+    printf("Total moves:       %llu\n", moveCount);
+    printf("Bytes written:     %llu\n", writer.bytesWritten);
+    printf("Execution time:    %.6f seconds\n", timeTaken);
+    printf("Moves per second:  %.0f\n", perSecond(moveCount, timeTaken));
+    printf("Throughput:        %.1f MB/s\n", perSecond(writer.bytesWritten, timeTaken) / 1e6);
+}
+
+// Streaming verifier for move sequences on three pegs. Pegs are bitmasks
+// as in Tower; a move is legal when the source is non-empty and the target
+// holds no disk smaller than the source's top disk.
+typedef struct {
+    int n;
+    unsigned long long peg[4];   // peg[3] stays empty so bad codes index safely
+    unsigned long long moves;    // Moves accepted so far
+    const char* error;           // NULL while the sequence is legal
+} MoveVerifier;
+
+// Codes (from<<2)|to with two different pegs 0-2
+static inline int validMoveCode(unsigned int code) {
+    return code < 16 && MOVE_FROM(code) < 3 && MOVE_TO(code) < 3 && MOVE_FROM(code) != MOVE_TO(code);
+}
+
+void initVerifier(MoveVerifier* verifier, int n) {
+    verifier->n = n;
+    verifier->peg[0] = calculateMoves(n);  // Disks 1..n on A
+    verifier->peg[1] = verifier->peg[2] = verifier->peg[3] = 0;
+    verifier->moves = 0;
+    verifier->error = NULL;
+}
+
+// Apply one move. disk is the disk the stream claims to move (0 = unknown).
+// Returns 0, or -1 with verifier->error set.
+static inline int verifyMove(MoveVerifier* verifier, int from, int to, int disk) {
+    if (from < 0 || from > 2 || to < 0 || to > 2 || from == to) {
+        verifier->error = "invalid peg";
+        return -1;
+    }
+    unsigned long long source = verifier->peg[from];
+    if (source == 0) {
+        verifier->error = "move from an empty peg";
+        return -1;
+    }
+    unsigned long long bit = source & -source;
+    if (disk != 0 && disk != __builtin_ctzll(source) + 1) {
+        verifier->error = "disk is not on top of the source peg";
+        return -1;
+    }
+    if (verifier->peg[to] & (bit - 1)) {
+        verifier->error = "larger disk placed on a smaller one";
+        return -1;
+    }
+    verifier->peg[from] ^= bit;
+    verifier->peg[to] |= bit;
+    verifier->moves++;
+    return 0;
+}
+
+// Verify a block of packed move bytes. The fast loop only accumulates an
+// error flag; if it trips, the block is replayed move by move from the
+// saved pegs to find and report the first bad move.
+int verifyBinaryBlock(MoveVerifier* verifier, const unsigned char* codes, size_t count) {
+    unsigned long long saved[4];
+    memcpy(saved, verifier->peg, sizeof(saved));
+    
+    unsigned long long* peg = verifier->peg;
+    unsigned long long bad = 0;
+    for (size_t i = 0; i < count; i++) {
+        unsigned int code = codes[i];
+        unsigned long long source = peg[MOVE_FROM(code)];
+        unsigned long long bit = source & -source;
+        bad |= !validMoveCode(code) | (source == 0) | ((peg[MOVE_TO(code)] & (bit - 1)) != 0);
+        peg[MOVE_FROM(code)] ^= bit;
+        peg[MOVE_TO(code)] |= bit;
+    }
+    
+    if (!bad) {
+        verifier->moves += count;
+        return 0;
+    }
+    memcpy(verifier->peg, saved, sizeof(saved));
+    for (size_t i = 0; i < count; i++) {
+        unsigned int code = codes[i];
+        if (code >= 16) {
+            verifier->error = "invalid move byte";
+            return -1;
+        }
+        if (verifyMove(verifier, MOVE_FROM(code), MOVE_TO(code), 0) != 0) return -1;
+    }
+    return 0;
+}
+
+// Parse an unsigned decimal number, advancing *text. Returns -1 if none.
+static inline long long parseNumber(const char** text, const char* end) {
+    const char* p = *text;
+    long long value = 0;
+    if (p >= end || *p < '0' || *p > '9') return -1;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (value > (LLONG_MAX - 9) / 10) return -1;  // Too many digits
+        value = value * 10 + (*p++ - '0');
+    }
+    *text = p;
+    return value;
+}
+
+// Verify one line "Move K: Move disk D from X to Y" (as the STREAM_TEXT
+// writer prints). Blank lines are skipped.
+int verifyTextLine(MoveVerifier* verifier, const char* line, const char* end) {
+    const char* p = line;
+    if (p == end) return 0;
+    
+    if (end - p < 5 || memcmp(p, "Move ", 5) != 0) goto malformed;
+    p += 5;
+    long long index = parseNumber(&p, end);
+    if (index < 0 || end - p < 12 || memcmp(p, ": Move disk ", 12) != 0) goto malformed;
+    p += 12;
+    long long disk = parseNumber(&p, end);
+    if (disk < 1 || disk > verifier->n || end - p != 12 || memcmp(p, " from ", 6) != 0 ||
+        memcmp(p + 7, " to ", 4) != 0) goto malformed;
+    if ((unsigned long long)index != verifier->moves + 1) {
+        verifier->error = "move numbers out of sequence";
+        return -1;
+    }
+    return verifyMove(verifier, p[6] - 'A', p[11] - 'A', (int)disk);
+    
+malformed:
+    verifier->error = "malformed line";
+    return -1;
+}
+
+// Verify a whole stream from a file descriptor, reading with read(2) in
+// WRITE_BUFFER chunks. Text lines may straddle chunks. Returns 0 if every
+// move is legal and all n disks end on C, -1 otherwise.
+int verifyStream(MoveVerifier* verifier, int fd, int mode) {
+    unsigned char* buffer = (unsigned char*)malloc(WRITE_BUFFER + 1);
+    if (buffer == NULL) {
+        verifier->error = "out of memory";
+        return -1;
+    }
+    
+    size_t carry = 0;  // Unfinished text line kept at the front
+    for (;;) {
+        ssize_t got = read(fd, buffer + carry, WRITE_BUFFER - carry);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            verifier->error = "read failed";
+            break;
+        }
+        if (got == 0) {
+            if (mode == STREAM_TEXT && carry > 0) {
+                verifyTextLine(verifier, (char*)buffer, (char*)buffer + carry);
+            }
+            break;
         }
         
-        printf("   ");
+        size_t size = carry + (size_t)got;
+        if (mode == STREAM_BINARY) {
+            if (verifyBinaryBlock(verifier, buffer, size) != 0) break;
+            continue;
+        }
         
-        // Tower C
-        if (level <= destination->top) {
-            int size = destination->disks[level].size;
-            for (int i = 0; i < n - size; i++) printf(" ");
-            for (int i = 0; i < size * 2 - 1; i++) printf("█");
-            for (int i = 0; i < n - size; i++) printf(" ");
-        } else {
-            for (int i = 0; i < n - 1; i++) printf(" ");
-            printf("│");
-            for (int i = 0; i < n - 1; i++) printf(" ");
+        char* text = (char*)buffer;
+        char* end = text + size;
+        char* line = text;
+        char* newline;
+        while ((newline = (char*)memchr(line, '\n', (size_t)(end - line))) != NULL) {
+            if (verifyTextLine(verifier, line, newline) != 0) break;
+            line = newline + 1;
         }
+        if (verifier->error != NULL) break;
         
-        printf("\n");
+        carry = (size_t)(end - line);
+        if (carry == WRITE_BUFFER) {
+            verifier->error = "line too long";
+            break;
+        }
+        memmove(buffer, line, carry);
     }
+    free(buffer);
     
-    // Base
-    printf("  ");
-    for (int i = 0; i < n * 2 - 1; i++) printf("═");
-    printf("   ");
-    for (int i = 0; i < n * 2 - 1; i++) printf("═");
-    printf("   ");
-    for (int i = 0; i < n * 2 - 1; i++) printf("═");
-    printf("\n");
+    if (verifier->error == NULL && verifier->peg[2] != calculateMoves(verifier->n)) {
+        verifier->error = "sequence ends before all disks are on C";
+    }
+    return verifier->error == NULL ? 0 : -1;
+}
+
+// Check the text parser on fixed lines: the first move is accepted, and a
+// 20-digit move number is rejected as malformed rather than overflowing
+int checkTextParser() {
+    const char* good = "Move 1: Move disk 1 from A to C";
+    const char* huge = "Move 99999999999999999999: Move disk 1 from A to C";
+    MoveVerifier verifier;
     
-    // Tower labels
-    printf("  ");
-    for (int i = 0; i < n - 1; i++) printf(" ");
-    printf("%c", source->name);
-    for (int i = 0; i < n - 1; i++) printf(" ");
-    printf("   ");
-    
-    for (int i = 0; i < n - 1; i++) printf(" ");
-    printf("%c", auxiliary->name);
-    for (int i = 0; i < n - 1; i++) printf(" ");
-    printf("   ");
-    
-    for (int i = 0; i < n - 1; i++) printf(" ");
-    printf("%c", destination->name);
-    for (int i = 0; i < n - 1; i++) printf(" ");
-    printf("\n");
+    initVerifier(&verifier, 3);
+    int ok = verifyTextLine(&verifier, good, good + strlen(good)) == 0;
+    initVerifier(&verifier, 3);
+    ok &= verifyTextLine(&verifier, huge, huge + strlen(huge)) != 0 &&
+          strcmp(verifier.error, "malformed line") == 0;
+    return ok;
+}
+
+// Verify a move stream from a file
+void runVerifier(int n, int mode, const char* path) {
+    printf("Parser check: %s\n", checkTextParser() ? "OK (20-digit move number rejected)" : "FAILED");
     
-    printf("════════════════════════════════════════════════════════\n");
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Cannot open %s!\n", path);
+        return;
+    }
+    
+    MoveVerifier verifier;
+    initVerifier(&verifier, n);
+    double start = nowSeconds();
+    int result = verifyStream(&verifier, fd, mode);
+    double timeTaken = nowSeconds() - start;
+    close(fd);
+    
+    if (result == 0) {
+        printf("✅ VALID: %llu legal moves, all %d disks on C", verifier.moves, n);
+        printf(verifier.moves == calculateMoves(n) ? " (optimal)\n" : "\n");
+    } else {
+        printf("❌ INVALID: %s (%llu legal moves before it)\n", verifier.error, verifier.moves);
+    }
+    printf("Execution time:    %.6f seconds\n", timeTaken);
+    printf("Moves per second:  %.0f\n", perSecond(verifier.moves, timeTaken));
 }
 
-// Basic recursive Tower of Hanoi - just shows moves
-void towerOfHanoiBasic(int n, char source, char destination, char auxiliary) {
-    if (n == 1) {
-        moveCount++;
-        printf("Move %d: Move disk 1 from %c to %c\n", moveCount, source, destination);
+// Number of online CPUs (at least 1)
+int onlineCpus() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+// One contiguous range of move numbers handled by one worker
+typedef struct {
+    int n;
+    unsigned long long first;  // First move number of the range
+    unsigned long long count;
+    unsigned char* out;        // This worker's slice of the output
+} MoveRange;
+
+// Worker: seek to the start of the range, then step the iterator
+void* generateMoveRange(void* arg) {
+    MoveRange* range = (MoveRange*)arg;
+    HanoiIterator it;
+    
+    initHanoiIterator(&it, range->n);
+    seekHanoiIterator(&it, range->first - 1);
+    
+    unsigned long long k = range->first;
+    for (unsigned long long i = 0; i < range->count; i++, k++) {
+        int disk = __builtin_ctzll(k) + 1;
+        int from = it.peg[disk];
+        int to = from + it.step[disk];
+        if (to >= 3) to -= 3;
+        it.peg[disk] = (unsigned char)to;
+        range->out[i] = PACK_MOVE(from, to);
+    }
+    return NULL;
+}
+
+// Generate count moves starting at move number first as packed bytes.
+// Because any move can be computed on its own, the range is split into
+// numThreads equal parts and each thread fills its own slice of out; the
+// slices are laid out back to back, so the result is already in order.
+void generateMovesParallel(int n, unsigned long long first, unsigned long long count,
+                           int numThreads, unsigned char* out) {
+    pthread_t threads[MAX_THREADS];
+    MoveRange ranges[MAX_THREADS];
+    int started[MAX_THREADS];
+    
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAX_THREADS) numThreads = MAX_THREADS;
+    if ((unsigned long long)numThreads > count) numThreads = count > 0 ? (int)count : 1;
+    
+    unsigned long long offset = 0;
+    for (int t = 0; t < numThreads; t++) {
+        unsigned long long size = count / numThreads + ((unsigned long long)t < count % numThreads);
+        ranges[t].n = n;
+        ranges[t].first = first + offset;
+        ranges[t].count = size;
+        ranges[t].out = out + offset;
+        offset += size;
+    }
+    
+    for (int t = 1; t < numThreads; t++) {
+        started[t] = pthread_create(&threads[t], NULL, generateMoveRange, &ranges[t]) == 0;
+        if (!started[t]) generateMoveRange(&ranges[t]);
+    }
+    generateMoveRange(&ranges[0]);
+    for (int t = 1; t < numThreads; t++) {
+        if (started[t]) pthread_join(threads[t], NULL);
+    }
+}
+
+// Time parallel generation of the full sequence at 1, 2, 4, ... threads
+void runParallelBenchmark(int n) {
+    unsigned long long total = calculateMoves(n);
+    unsigned char* reference = (unsigned char*)malloc(total);
+    unsigned char* out = (unsigned char*)malloc(total);
+    if (reference == NULL || out == NULL) {
+        printf("Not enough memory for %llu moves!\n", total);
+        free(reference);
+        free(out);
         return;
     }
     
-    // Move n-1 disks from source to auxiliary using destination
-    towerOfHanoiBasic(n - 1, source, auxiliary, destination);
+    // Single-threaded reference, also checked against the closed form
+    double start = nowSeconds();
+    generateMovesParallel(n, 1, total, 1, reference);
+    double baseTime = nowSeconds() - start;
     
-    // Move the largest disk from source to destination
-    moveCount++;
-    printf("Move %d: Move disk %d from %c to %c\n", moveCount, n, source, destination);
+    int sampleOk = 1;
+    for (unsigned long long k = 1; k <= total; k += total / 1000 + 1) {
+        HanoiMove move;
+        hanoiMoveAt(n, k, &move);
+        sampleOk &= reference[k - 1] == PACK_MOVE(move.from, move.to);
+    }
     
-    // Move n-1 disks from auxiliary to destination using source
-    towerOfHanoiBasic(n - 1, auxiliary, destination, source);
+    printf("Total moves: %llu (%.1f MB as 1 byte/move), spot check %s\n\n",
+           total, total / 1e6, sampleOk ? "OK" : "FAILED");
+    printf("%-8s %-12s %-16s %-8s %-8s\n", "Threads", "Time (s)", "Moves/second", "Speedup", "Output");
+    printf("----------------------------------------------------------\n");
+    printf("%-8d %-12.4f %-16.0f %-8.2f %-8s\n", 1, baseTime, perSecond(total, baseTime), 1.0, "ref");
+    
+    int maxThreads = onlineCpus() < MAX_THREADS ? onlineCpus() : MAX_THREADS;
+    // Every power of two up to the CPU count, then the CPU count itself if
+    // it is not one (6 CPUs: 2, 4, 6)
+    for (int threads = 2; threads <= maxThreads;
+         threads = threads * 2 <= maxThreads || threads == maxThreads ? threads * 2 : maxThreads) {
+        start = nowSeconds();
+        generateMovesParallel(n, 1, total, threads, out);
+        double elapsed = nowSeconds() - start;
+        printf("%-8d %-12.4f %-16.0f %-8.2f %-8s\n", threads, elapsed, perSecond(total, elapsed),
+               baseTime / elapsed, memcmp(out, reference, total) == 0 ? "same" : "DIFFERS");
+    }
+    if (maxThreads == 1) {
+        printf("(only one CPU online; no scaling to show)\n");
+    }
+    
+    free(reference);
+    free(out);
 }
 
-// Advanced Tower of Hanoi with visualization
-void towerOfHanoiVisual(int n, Tower* source, Tower* auxiliary, Tower* destination, 
-                        int totalDisks, int delay) {
-    if (n == 1) {
-        moveCount++;
-        int disk = pop(source);
-        printf("\n>>> Move %d: Move disk %d from %c to %c\n", 
-               moveCount, disk, source->name, destination->name);
-        push(destination, disk);
+// Phase timing over repeated runs. Each run solves into packed move bytes,
+// formats them as text, and writes the text out; every phase is timed
+// separately with the nanosecond monotonic clock.
+#define PHASE_SOLVE 0
+#define PHASE_FORMAT 1
+#define PHASE_OUTPUT 2
+#define PHASE_COUNT 3
+#define MAX_TIMING_RUNS 1000
+
+// Report formats
+#define REPORT_TABLE 0
+#define REPORT_CSV 1
+#define REPORT_JSON 2
+
+const char* PHASE_NAMES[PHASE_COUNT] = {"solve", "format", "output"};
+
+typedef struct {
+    unsigned long long min;
+    unsigned long long median;
+    unsigned long long p90;
+    unsigned long long p99;
+    unsigned long long max;
+    double mean;
+} TimingStats;
+
+int compareNanos(const void* a, const void* b) {
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static inline unsigned long long percentile(const unsigned long long* sorted, int count, int p) {
+    int rank = (p * count + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+// Summary statistics of count samples (sorts them in place)
+void computeTimingStats(unsigned long long* samples, int count, TimingStats* stats) {
+    qsort(samples, (size_t)count, sizeof(unsigned long long), compareNanos);
+    double sum = 0;
+    for (int i = 0; i < count; i++) sum += samples[i];
+    
+    stats->min = samples[0];
+    stats->median = percentile(samples, count, 50);
+    stats->p90 = percentile(samples, count, 90);
+    stats->p99 = percentile(samples, count, 99);
+    stats->max = samples[count - 1];
+    stats->mean = sum / count;
+}
+
+// Text lines for count packed moves starting at move number first.
+// Returns the bytes written to out.
+size_t formatMoveCodes(const unsigned char* codes, unsigned long long first, unsigned long long count, char* out) {
+    size_t used = 0;
+    for (unsigned long long i = 0; i < count; i++) {
+        unsigned long long k = first + i;
+        used += (size_t)formatMoveLine(out + used, k, __builtin_ctzll(k) + 1,
+                                       MOVE_FROM(codes[i]), MOVE_TO(codes[i]));
+    }
+    return used;
+}
+
+// Time runs repetitions of solve / format / output for n disks and report
+// per-phase statistics. Output goes to path (e.g. /dev/null).
+void runTimingReport(int n, int runs, int format, const char* path) {
+    if (format != REPORT_TABLE && format != REPORT_CSV && format != REPORT_JSON) {
+        printf("Invalid report format!\n");
+        return;
+    }
+    
+    unsigned long long total = calculateMoves(n);
+    unsigned char* codes = (unsigned char*)malloc(total);
+    char* text = (char*)malloc(total * MAX_MOVE_LINE);
+    unsigned long long* samples[PHASE_COUNT];
+    for (int ph = 0; ph < PHASE_COUNT; ph++) {
+        samples[ph] = (unsigned long long*)malloc(sizeof(unsigned long long) * runs);
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    
+    if (codes == NULL || text == NULL || samples[0] == NULL || samples[1] == NULL || samples[2] == NULL) {
+        printf("Memory allocation failed!\n");
+    } else if (fd < 0) {
+        printf("Cannot open %s!\n", path);
+    } else {
+        size_t textBytes = 0;
+        int written = 1;
+        for (int r = 0; r < runs && written; r++) {
+            unsigned long long t0 = nowNanos();
+            generateMovesParallel(n, 1, total, 1, codes);
+            unsigned long long t1 = nowNanos();
+            textBytes = formatMoveCodes(codes, 1, total, text);
+            unsigned long long t2 = nowNanos();
+            lseek(fd, 0, SEEK_SET);
+            written = writeAll(fd, text, textBytes) == textBytes;
+            unsigned long long t3 = nowNanos();
+            
+            samples[PHASE_SOLVE][r] = t1 - t0;
+            samples[PHASE_FORMAT][r] = t2 - t1;
+            samples[PHASE_OUTPUT][r] = t3 - t2;
+        }
         
-        if (delay > 0) {
-            displayTowers(source, auxiliary, destination, totalDisks);
-            // Simple delay
-            for (long i = 0; i < delay * 100000000L; i++);
+        TimingStats stats[PHASE_COUNT];
+        for (int ph = 0; ph < PHASE_COUNT && written; ph++) {
+            computeTimingStats(samples[ph], runs, &stats[ph]);
+        }
+        
+        if (!written) {
+            printf("Write to %s failed!\n", path);
+        } else if (format == REPORT_CSV) {
+            printf("phase,disks,moves,runs,min_ns,median_ns,p90_ns,p99_ns,max_ns,mean_ns,ns_per_move,moves_per_second\n");
+            for (int ph = 0; ph < PHASE_COUNT; ph++) {
+                printf("%s,%d,%llu,%d,%llu,%llu,%llu,%llu,%llu,%.0f,%.3f,%.0f\n", PHASE_NAMES[ph], n, total, runs,
+                       stats[ph].min, stats[ph].median, stats[ph].p90, stats[ph].p99, stats[ph].max, stats[ph].mean,
+                       (double)stats[ph].median / total, perSecond(total, stats[ph].median * 1e-9));
+            }
+        } else if (format == REPORT_JSON) {
+            printf("{\"disks\": %d, \"moves\": %llu, \"runs\": %d, \"text_bytes\": %zu, \"phases\": [\n",
+                   n, total, runs, textBytes);
+            for (int ph = 0; ph < PHASE_COUNT; ph++) {
+                printf("  {\"phase\": \"%s\", \"min_ns\": %llu, \"median_ns\": %llu, \"p90_ns\": %llu, "
+                       "\"p99_ns\": %llu, \"max_ns\": %llu, \"mean_ns\": %.0f, \"ns_per_move\": %.3f, "
+                       "\"moves_per_second\": %.0f}%s\n", PHASE_NAMES[ph], stats[ph].min, stats[ph].median,
+                       stats[ph].p90, stats[ph].p99, stats[ph].max, stats[ph].mean,
+                       (double)stats[ph].median / total, perSecond(total, stats[ph].median * 1e-9),
+                       ph + 1 < PHASE_COUNT ? "," : "");
+            }
+            printf("]}\n");
+        } else {
+            printf("Disks: %d, moves: %llu, runs: %d, text: %zu bytes\n\n", n, total, runs, textBytes);
+            printf("%-8s %12s %12s %12s %12s %12s %10s %14s\n", "Phase", "Min (ms)", "Median (ms)",
+                   "P90 (ms)", "P99 (ms)", "Max (ms)", "ns/move", "Moves/second");
+            printf("--------------------------------------------------------------------------------------------------\n");
+            for (int ph = 0; ph < PHASE_COUNT; ph++) {
+                printf("%-8s %12.3f %12.3f %12.3f %12.3f %12.3f %10.3f %14.0f\n", PHASE_NAMES[ph],
+                       stats[ph].min * 1e-6, stats[ph].median * 1e-6, stats[ph].p90 * 1e-6,
+                       stats[ph].p99 * 1e-6, stats[ph].max * 1e-6, (double)stats[ph].median / total,
+                       perSecond(total, stats[ph].median * 1e-9));
+            }
+        }
+    }
+    
+    if (fd >= 0) close(fd);
+    for (int ph = 0; ph < PHASE_COUNT; ph++) free(samples[ph]);
+    free(codes);
+    free(text);
+}
+
+// Frame-Stewart solver for 3 to MAX_PEGS pegs.
+// With p pegs, move the top t disks to a spare peg (all p pegs usable),
+// the remaining n - t disks to the target (p - 1 pegs usable), then the t
+// disks onto them. fsMoves[p][n] is the minimum over t, fsSplit[p][n] the t
+// that achieves it. The table is filled once per peg count and then reused.
+unsigned long long fsMoves[MAX_PEGS + 1][MAX_DISKS + 1];
+int fsSplit[MAX_PEGS + 1][MAX_DISKS + 1];
+int fsReady[MAX_PEGS + 1];
+
+static inline unsigned long long saturatingAdd(unsigned long long a, unsigned long long b) {
+    return a + b < a ? ~0ULL : a + b;
+}
+
+// Fill the split table for every peg count up to pegs (no-op if cached)
+void buildFrameStewartTable(int pegs) {
+    for (int p = 3; p <= pegs; p++) {
+        if (fsReady[p]) continue;
+        
+        for (int n = 0; n <= MAX_DISKS; n++) {
+            if (p == 3 || n <= 1) {
+                fsMoves[p][n] = calculateMoves(n);
+                fsSplit[p][n] = n > 0 ? n - 1 : 0;
+                continue;
+            }
+            
+            fsMoves[p][n] = ~0ULL;
+            for (int t = 1; t < n; t++) {
+                unsigned long long moves = saturatingAdd(saturatingAdd(fsMoves[p][t], fsMoves[p][t]),
+                                                         fsMoves[p - 1][n - t]);
+                if (moves < fsMoves[p][n]) {
+                    fsMoves[p][n] = moves;
+                    fsSplit[p][n] = t;
+                }
+            }
+        }
+        fsReady[p] = 1;
+    }
+}
+
+// Minimum number of moves for n disks on the given number of pegs
+unsigned long long frameStewartMoves(int n, int pegs) {
+    buildFrameStewartTable(pegs);
+    return fsMoves[pegs][n];
+}
+
+// Pending subproblem: move disks base+1 .. base+count from one peg to
+// another, using the pegs in spareMask as intermediates
+typedef struct {
+    int count;
+    int base;
+    int from;
+    int to;
+    unsigned int spareMask;
+} StewartTask;
+
+// Generate the Frame-Stewart moves for n disks from peg 0 to peg pegs-1.
+// Uses an explicit task stack instead of recursion; three-peg subproblems
+// run on the binary-counter iterator. Returns the number of moves.
+unsigned long long solveFrameStewart(int n, int pegs, HanoiCallback callback, void* context) {
+    // Each split replaces one task by three with fewer disks
+    StewartTask stack[2 * MAX_DISKS + 2];
+    int top = 0;
+    unsigned long long index = 0;
+    
+    buildFrameStewartTable(pegs);
+    stack[top++] = (StewartTask){n, 0, 0, pegs - 1, ((1u << pegs) - 1) & ~1u & ~(1u << (pegs - 1))};
+    
+    while (top > 0) {
+        StewartTask task = stack[--top];
+        if (task.count == 0) continue;
+        
+        int spare = __builtin_ctz(task.spareMask);
+        int available = __builtin_popcount(task.spareMask) + 2;
+        
+        if (available == 3 || task.count == 1) {
+            // Classic three-peg run, local pegs 0/1/2 = from/spare/to
+            int map[3] = {task.from, spare, task.to};
+            HanoiIterator it;
+            HanoiMove move;
+            initHanoiIterator(&it, task.count);
+            while (hanoiNext(&it, &move)) {
+                move.index = ++index;
+                move.disk += task.base;
+                move.from = map[move.from];
+                move.to = map[move.to];
+                callback(&move, context);
+            }
+            continue;
         }
+        
+        // Pushed in reverse so they run in order
+        int t = fsSplit[available][task.count];
+        unsigned int rest = task.spareMask & ~(1u << spare);
+        stack[top++] = (StewartTask){t, task.base, spare, task.to, rest | (1u << task.from)};
+        stack[top++] = (StewartTask){task.count - t, task.base + t, task.from, task.to, rest};
+        stack[top++] = (StewartTask){t, task.base, task.from, spare, rest | (1u << task.to)};
+    }
+    return index;
+}
+
+// Print a move from the multi-peg solver
+void printMove(const HanoiMove* move, void* context) {
+    (void)context;
+    printf("Move %llu: Move disk %d from %c to %c\n", move->index, move->disk,
+           PEG_NAMES[move->from], PEG_NAMES[move->to]);
+}
+
+// Frame-Stewart table, moves (or a verified replay) and cached-solve timing
+void runFrameStewart(int n, int pegs) {
+    double start = nowSeconds();
+    buildFrameStewartTable(pegs);
+    double buildTime = nowSeconds() - start;
+    
+    printf("%-6s", "Disks");
+    for (int p = 3; p <= pegs; p++) printf("  %16d pegs", p);
+    printf("\n");
+    for (int i = 1; i <= n && i <= 20; i++) {
+        printf("%-6d", i);
+        for (int p = 3; p <= pegs; p++) printf("  %14llu (t=%2d)", fsMoves[p][i], fsSplit[p][i]);
+        printf("\n");
+    }
+    printf("\nSplit table built in %.6f seconds (cached for later solves)\n", buildTime);
+    
+    unsigned long long total = frameStewartMoves(n, pegs);
+    printf("Minimum moves for %d disks on %d pegs: %llu\n\n", n, pegs, total);
+    if (total > (1ULL << 28)) {
+        printf("Too many moves to generate here.\n");
         return;
     }
+    if (total <= 64) {
+        solveFrameStewart(n, pegs, printMove, NULL);
+        printf("\n");
+    }
     
-    // Move n-1 disks from source to auxiliary using destination
-    towerOfHanoiVisual(n - 1, source, destination, auxiliary, totalDisks, delay);
+    // Replay every move on bitmask towers, then time repeated solves
+    Tower towers[MAX_PEGS];
+    ReplayContext replay;
+    for (int p = 0; p < pegs; p++) {
+        initTower(&towers[p], PEG_NAMES[p]);
+        replay.pegs[p] = &towers[p];
+    }
+    for (int i = n; i >= 1; i--) {
+        push(&towers[0], i);
+    }
+    replay.illegal = 0;
+    unsigned long long generated = solveFrameStewart(n, pegs, replayMove, &replay);
+    int solved = replay.illegal == 0 && generated == total && diskCount(&towers[pegs - 1]) == n;
+    printf("Replay check: %s\n", solved ? "all moves legal, all disks on the last peg" : "FAILED");
     
-    // Move the largest disk
-    moveCount++;
-    int disk = pop(source);
-    printf("\n>>> Move %d: Move disk %d from %c to %c\n", 
-           moveCount, disk, source->name, destination->name);
-    push(destination, disk);
+    unsigned long long checksum = 0;
+    int runs = 5;
+    start = nowSeconds();
+    for (int r = 0; r < runs; r++) {
+        solveFrameStewart(n, pegs, checksumMove, &checksum);
+    }
+    double solveTime = (nowSeconds() - start) / runs;
+    printf("Solve time:   %.6f seconds per run, %.0f moves/second (checksum %llx)\n",
+           solveTime, perSecond(total, solveTime), checksum);
+}
+
+// Shortest path between two arbitrary configurations on three pegs.
+// peg[d] gives the peg (0-2) of disk d for d = 1..n; any such vector is a
+// legal position because each peg's disks stack largest at the bottom.
+// Only the largest disk d that differs matters: it moves once, via a
+// tower of the smaller disks on the spare peg, or twice (to the spare and
+// then the target) when gathering and spreading around that is cheaper.
+// Both costs come from O(n) formulas, so no search is needed.
+typedef struct {
+    unsigned char peg[MAX_DISKS + 1];  // Current position, updated per move
+    unsigned long long index;
+    HanoiCallback callback;
+    void* context;
+} ConfigSolver;
+
+// Moves to gather disks 1..m of a configuration into one tower on peg p
+unsigned long long gatherCost(const unsigned char peg[], int m, int p) {
+    unsigned long long moves = 0;
+    for (int k = m; k >= 1; k--) {
+        if (peg[k] != p) {
+            moves += 1ULL << (k - 1);
+            p = 3 - peg[k] - p;
+        }
+    }
+    return moves;
+}
+
+static inline void emitConfigMove(ConfigSolver* solver, int disk, int from, int to) {
+    HanoiMove move = {++solver->index, disk, from, to};
+    solver->peg[disk] = (unsigned char)to;
+    solver->callback(&move, solver->context);
+}
+
+// Move the tower of disks 1..m from one peg to another
+void moveConfigTower(ConfigSolver* solver, int m, int from, int to) {
+    int map[3] = {from, 3 - from - to, to};
+    HanoiIterator it;
+    HanoiMove move;
     
-    if (delay > 0) {
-        displayTowers(source, auxiliary, destination, totalDisks);
-        // Simple delay
-        for (long i = 0; i < delay * 100000000L; i++);
+    initHanoiIterator(&it, m);
+    while (hanoiNext(&it, &move)) {
+        emitConfigMove(solver, move.disk, map[move.from], map[move.to]);
+    }
+}
+
+// Gather disks 1..m onto peg p. pivot[k] is the peg disks 1..k must be
+// on before disk k+1 is placed; working upward, each misplaced disk moves
+// once and the tower above it follows.
+void gatherDisks(ConfigSolver* solver, int m, int p) {
+    unsigned char pivot[MAX_DISKS + 1];
+    pivot[m] = (unsigned char)p;
+    for (int k = m; k >= 1; k--) {
+        pivot[k - 1] = solver->peg[k] == pivot[k] ? pivot[k] : (unsigned char)(3 - solver->peg[k] - pivot[k]);
     }
     
-    // Move n-1 disks from auxiliary to destination using source
-    towerOfHanoiVisual(n - 1, auxiliary, source, destination, totalDisks, delay);
+    for (int k = 1; k <= m; k++) {
+        if (solver->peg[k] != pivot[k]) {
+            emitConfigMove(solver, k, solver->peg[k], pivot[k]);
+            moveConfigTower(solver, k - 1, pivot[k - 1], pivot[k]);
+        }
+    }
+}
+
+// Spread a tower of disks 1..m on peg p out to the target configuration
+void distributeDisks(ConfigSolver* solver, const unsigned char target[], int m, int p) {
+    for (int k = m; k >= 1; k--) {
+        if (target[k] != p) {
+            int other = 3 - p - target[k];
+            moveConfigTower(solver, k - 1, p, other);
+            emitConfigMove(solver, k, p, target[k]);
+            p = other;
+        }
+    }
 }
 
-// Calculate total moves (2^n - 1)
-long long calculateMoves(int n) {
-    long long moves = 1;
-    for (int i = 0; i < n; i++) {
-        moves *= 2;
+// Minimum number of moves from start to target, in O(n)
+unsigned long long configDistance(int n, const unsigned char start[], const unsigned char target[]) {
+    int d = n;
+    while (d >= 1 && start[d] == target[d]) d--;
+    if (d == 0) return 0;
+    
+    int from = start[d], to = target[d], spare = 3 - from - to;
+    unsigned long long once = saturatingAdd(gatherCost(start, d - 1, spare) + 1,
+                                            gatherCost(target, d - 1, spare));
+    unsigned long long twice = saturatingAdd(saturatingAdd(gatherCost(start, d - 1, to), 1ULL << (d - 1)),
+                                             saturatingAdd(1, gatherCost(target, d - 1, from)));
+    return once < twice ? once : twice;
+}
+
+// Emit the optimal moves from start to target. Returns the number of moves.
+unsigned long long solveFromConfig(int n, const unsigned char start[], const unsigned char target[],
+                                   HanoiCallback callback, void* context) {
+    ConfigSolver solver;
+    memcpy(solver.peg, start, (size_t)n + 1);
+    solver.index = 0;
+    solver.callback = callback;
+    solver.context = context;
+    
+    int d = n;
+    while (d >= 1 && start[d] == target[d]) d--;
+    if (d == 0) return 0;
+    
+    int from = start[d], to = target[d], spare = 3 - from - to;
+    unsigned long long once = saturatingAdd(gatherCost(start, d - 1, spare) + 1,
+                                            gatherCost(target, d - 1, spare));
+    if (once <= configDistance(n, start, target)) {
+        gatherDisks(&solver, d - 1, spare);
+        emitConfigMove(&solver, d, from, to);
+        distributeDisks(&solver, target, d - 1, spare);
+    } else {
+        gatherDisks(&solver, d - 1, to);
+        emitConfigMove(&solver, d, from, spare);
+        moveConfigTower(&solver, d - 1, to, from);
+        emitConfigMove(&solver, d, spare, to);
+        distributeDisks(&solver, target, d - 1, from);
+    }
+    return solver.index;
+}
+
+// Parse one peg letter per disk, smallest disk first. Returns 0 or -1.
+int parseConfig(const char* text, int n, unsigned char peg[]) {
+    if ((int)strlen(text) != n) {
+        printf("Expected %d peg letters!\n", n);
+        return -1;
+    }
+    for (int d = 1; d <= n; d++) {
+        char c = text[d - 1];
+        if (c >= 'a' && c <= 'c') c = (char)(c - 'a' + 'A');
+        if (c < 'A' || c > 'C') {
+            printf("Invalid peg '%c'!\n", text[d - 1]);
+            return -1;
+        }
+        peg[d] = (unsigned char)(c - 'A');
+    }
+    return 0;
+}
+
+// Solve between two configurations, replaying the moves to check them
+void runConfigSolver(int n, const unsigned char start[], const unsigned char target[]) {
+    unsigned long long distance = configDistance(n, start, target);
+    printf("Minimum moves: %llu\n\n", distance);
+    if (distance > (1ULL << 28)) {
+        printf("Too many moves to generate here.\n");
+        return;
+    }
+    if (distance <= 64) {
+        solveFromConfig(n, start, target, printMove, NULL);
+        printf("\n");
+    }
+    
+    Tower towers[3];
+    ReplayContext replay;
+    for (int p = 0; p < 3; p++) {
+        initTower(&towers[p], PEG_NAMES[p]);
+        replay.pegs[p] = &towers[p];
+    }
+    for (int d = 1; d <= n; d++) {
+        push(&towers[start[d]], d);
+    }
+    replay.illegal = 0;
+    
+    double begin = nowSeconds();
+    unsigned long long generated = solveFromConfig(n, start, target, replayMove, &replay);
+    double elapsed = nowSeconds() - begin;
+    
+    int reached = 1;
+    for (int d = 1; d <= n; d++) {
+        reached &= (towers[target[d]].disks >> (d - 1)) & 1;
+    }
+    printf("Replay check: %s (%llu moves in %.6f seconds)\n",
+           replay.illegal == 0 && reached && generated == distance ? "all moves legal, target reached" : "FAILED",
+           generated, elapsed);
+    
+    // A state on the optimal A->C path resumes with exactly the remaining moves
+    unsigned long long k;
+    int allOnC = 1;
+    for (int d = 1; d <= n; d++) allOnC &= target[d] == 2;
+    if (allOnC && hanoiMoveIndex(n, start, &k)) {
+        printf("Start is move %llu of the standard solution; remaining %llu %s\n",
+               k, calculateMoves(n) - k, calculateMoves(n) - k == distance ? "✓" : "✗");
     }
-    return moves - 1;
 }
 
 // Display theory and complexity
@@ -212,7 +1600,7 @@ void displayTheory(int n) {
     printf("⏱️  COMPLEXITY ANALYSIS:\n");
     printf("  Time Complexity:  O(2^n)\n");
     printf("  Space Complexity: O(n) - recursion stack depth\n");
-    printf("  Total Moves:      2^%d - 1 = %lld moves\n\n", n, calculateMoves(n));
+    printf("  Total Moves:      2^%d - 1 = %llu moves\n\n", n, calculateMoves(n));
     
     // Show growth
     printf("📊 EXPONENTIAL GROWTH:\n");
@@ -220,15 +1608,15 @@ void displayTheory(int n) {
     printf("  │ Disks  │ Total Moves  │   Time (1 sec/move) │\n");
     printf("  ├────────┼──────────────┼─────────────────────┤\n");
     for (int i = 1; i <= 10; i++) {
-        long long moves = calculateMoves(i);
+        unsigned long long moves = calculateMoves(i);
         if (moves < 60) {
-            printf("  │   %2d   │   %10lld │      %lld seconds       │\n", i, moves, moves);
+            printf("  │   %2d   │   %10llu │      %llu seconds       │\n", i, moves, moves);
         } else if (moves < 3600) {
-            printf("  │   %2d   │   %10lld │      %lld minutes       │\n", i, moves, moves / 60);
+            printf("  │   %2d   │   %10llu │      %llu minutes       │\n", i, moves, moves / 60);
         } else if (moves < 86400) {
-            printf("  │   %2d   │   %10lld │      %.1f hours         │\n", i, moves, moves / 3600.0);
+            printf("  │   %2d   │   %10llu │      %.1f hours         │\n", i, moves, moves / 3600.0);
         } else {
-            printf("  │   %2d   │   %10lld │      %.1f days          │\n", i, moves, moves / 86400.0);
+            printf("  │   %2d   │   %10llu │      %.1f days          │\n", i, moves, moves / 86400.0);
         }
     }
     printf("  └────────┴──────────────┴─────────────────────┘\n\n");
@@ -252,17 +1640,154 @@ int main() {
     printf("2. Basic Solution (Text Only)\n");
     printf("3. Visual Solution (Animated)\n");
     printf("4. All Three\n");
-    printf("\nEnter choice (1-4): ");
+    printf("5. Iterative Engine (Benchmark, up to 40 disks)\n");
+    printf("6. Jump to Move k (State Query, up to 64 disks)\n");
+    printf("7. Parallel Generation (Scaling Benchmark, up to 32 disks)\n");
+    printf("8. Stream to File (Binary or Text, up to 30 disks)\n");
+    printf("9. Frame-Stewart Solver (3-%d Pegs, up to 64 disks)\n", MAX_PEGS);
+    printf("10. Solve From Any State (Resume, up to 64 disks)\n");
+    printf("11. Verify Move Stream (Binary or Text File, up to 64 disks)\n");
+    printf("12. Phase Timing Report (Table, CSV or JSON, up to 22 disks)\n");
+    printf("\nEnter choice (1-12): ");
     scanf("%d", &choice);
     
     printf("\nEnter number of disks (1-10 recommended): ");
     scanf("%d", &n);
     
-    if (n < 1 || n > 20) {
+    int maxDisks = MAX_VISUAL_DISKS;
+    if (choice == 5) maxDisks = 40;
+    if (choice == 6) maxDisks = MAX_DISKS;
+    if (choice == 7) maxDisks = 32;
+    if (choice == 8) maxDisks = 30;
+    if (choice == 9 || choice == 10 || choice == 11) maxDisks = MAX_DISKS;
+    if (choice == 12) maxDisks = 22;
+    if (n < 1 || n > maxDisks) {
         printf("Invalid number! Using n=3\n");
         n = 3;
     }
     
+    if (choice == 12) {
+        int runs, format;
+        char path[256];
+        printf("Number of runs (1-%d): ", MAX_TIMING_RUNS);
+        scanf("%d", &runs);
+        if (runs < 1 || runs > MAX_TIMING_RUNS) {
+            printf("Invalid number! Using 11 runs\n");
+            runs = 11;
+        }
+        printf("Report (0=Table, 1=CSV, 2=JSON): ");
+        scanf("%d", &format);
+        printf("Output file for the text phase (e.g. /dev/null): ");
+        scanf("%255s", path);
+        printf("\n");
+        runTimingReport(n, runs, format, path);
+        return 0;
+    }
+    
+    if (choice == 11) {
+        int mode;
+        char path[256];
+        printf("Format (0=Binary, 1=Text): ");
+        scanf("%d", &mode);
+        if (mode != STREAM_BINARY && mode != STREAM_TEXT) {
+            printf("Invalid format! Using binary\n");
+            mode = STREAM_BINARY;
+        }
+        printf("Input file: ");
+        scanf("%255s", path);
+        
+        printf("\n═══════════════════════════════════════════════════════════\n");
+        printf("             MOVE STREAM VERIFIER\n");
+        printf("═══════════════════════════════════════════════════════════\n\n");
+        runVerifier(n, mode, path);
+        return 0;
+    }
+    
+    if (choice == 10) {
+        char text[MAX_DISKS + 1];
+        unsigned char start[MAX_DISKS + 1], target[MAX_DISKS + 1];
+        printf("Start state, one peg letter per disk from the smallest (e.g. ABBC): ");
+        scanf("%64s", text);
+        if (parseConfig(text, n, start) != 0) return 1;
+        printf("Target state (or C for all on C): ");
+        scanf("%64s", text);
+        if (strcmp(text, "C") == 0 || strcmp(text, "c") == 0) {
+            for (int d = 1; d <= n; d++) target[d] = 2;
+        } else if (parseConfig(text, n, target) != 0) {
+            return 1;
+        }
+        
+        printf("\n═══════════════════════════════════════════════════════════\n");
+        printf("             SOLVE FROM ANY STATE\n");
+        printf("═══════════════════════════════════════════════════════════\n\n");
+        runConfigSolver(n, start, target);
+        return 0;
+    }
+    
+    if (choice == 9) {
+        int pegs;
+        printf("Number of pegs (3-%d): ", MAX_PEGS);
+        scanf("%d", &pegs);
+        if (pegs < 3 || pegs > MAX_PEGS) {
+            printf("Invalid number! Using 4 pegs\n");
+            pegs = 4;
+        }
+        
+        printf("\n═══════════════════════════════════════════════════════════\n");
+        printf("             FRAME-STEWART MULTI-PEG SOLVER\n");
+        printf("═══════════════════════════════════════════════════════════\n\n");
+        runFrameStewart(n, pegs);
+        return 0;
+    }
+    
+    if (choice == 8) {
+        int mode;
+        char path[256];
+        printf("Format (0=Binary, 1=Text): ");
+        scanf("%d", &mode);
+        if (mode != STREAM_BINARY && mode != STREAM_TEXT) {
+            printf("Invalid format! Using binary\n");
+            mode = STREAM_BINARY;
+        }
+        printf("Output file: ");
+        scanf("%255s", path);
+        
+        printf("\n═══════════════════════════════════════════════════════════\n");
+        printf("             STREAMED OUTPUT\n");
+        printf("═══════════════════════════════════════════════════════════\n\n");
+        runStreamOutput(n, mode, path);
+        return 0;
+    }
+    
+    if (choice == 7) {
+        printf("\n═══════════════════════════════════════════════════════════\n");
+        printf("             PARALLEL MOVE GENERATION\n");
+        printf("═══════════════════════════════════════════════════════════\n\n");
+        runParallelBenchmark(n);
+        return 0;
+    }
+    
+    if (choice == 6) {
+        unsigned long long k;
+        printf("Enter move index k (0-%llu): ", calculateMoves(n));
+        scanf("%llu", &k);
+        if (k > calculateMoves(n)) {
+            printf("Invalid move index! Using k=0\n");
+            k = 0;
+        }
+        printf("\n");
+        runJumpToMove(n, k);
+        return 0;
+    }
+    
+    if (choice == 5) {
+        printf("\n═══════════════════════════════════════════════════════════\n");
+        printf("             ITERATIVE ENGINE (BINARY COUNTER)\n");
+        printf("═══════════════════════════════════════════════════════════\n\n");
+        runIterativeBenchmark(n);
+        return 0;
+    }
+    
     if (choice == 1 || choice == 4) {
         displayTheory(n);
         if (choice == 1) return 0;
@@ -273,17 +1798,22 @@ int main() {
         printf("             BASIC SOLUTION (TEXT ONLY)\n");
         printf("═══════════════════════════════════════════════════════════\n\n");
         
-        moveCount = 0;
-        clock_t start = clock();
-        towerOfHanoiBasic(n, 'A', 'C', 'B');
-        clock_t end = clock();
+        // One text line per move, written through one buffered
+        // write(2) per megabyte instead of a printf per move
+        MoveWriter writer;
+        if (initMoveWriter(&writer, STDOUT_FILENO, STREAM_TEXT) != 0) return 1;
+        fflush(stdout);
         
-        double timeTaken = ((double)(end - start)) / CLOCKS_PER_SEC;
+        moveCount = 0;
+        double start = nowSeconds();
+        towerOfHanoiStream(n, 0, 2, 1, &writer);
+        closeMoveWriter(&writer);
+        double timeTaken = nowSeconds() - start;
         
         printf("\n✅ Solution completed!\n");
-        printf("Total moves: %d\n", moveCount);
+        printf("Total moves: %llu\n", moveCount);
         printf("Execution time: %.6f seconds\n", timeTaken);
-        printf("Moves per second: %.0f\n\n", moveCount / timeTaken);
+        printf("Moves per second: %.0f\n\n", perSecond(moveCount, timeTaken));
         
         if (choice == 2) return 0;
     }
@@ -318,12 +1848,17 @@ int main() {
         getchar();
         
         moveCount = 0;
-        clock_t start = clock();
+        double start = nowSeconds();
         
-        towerOfHanoiVisual(n, &towerA, &towerB, &towerC, n, delay);
+        if (delay > 0) {
+            printf("\n");
+            startAnimation(&towerA, &towerB, &towerC, n, delay);
+            animateFrame("Starting...");
+        }
+        towerOfHanoiVisual(n, &towerA, &towerB, &towerC, delay);
+        if (delay > 0) waitNextFrame();  // Hold the last move on screen too
         
-        clock_t end = clock();
-        double timeTaken = ((double)(end - start)) / CLOCKS_PER_SEC;
+        double timeTaken = nowSeconds() - start;
         
         printf("\n\n🎉 PUZZLE SOLVED! 🎉\n");
         printf("\nFinal State:");
@@ -332,10 +1867,10 @@ int main() {
         printf("\n╔══════════════════════════════════════════════════════════╗\n");
         printf("║                    STATISTICS                            ║\n");
         printf("╠══════════════════════════════════════════════════════════╣\n");
-        printf("║  Total Moves:         %-10d                        ║\n", moveCount);
-        printf("║  Expected Moves:      %-10lld                        ║\n", calculateMoves(n));
+        printf("║  Total Moves:         %-10llu                        ║\n", moveCount);
+        printf("║  Expected Moves:      %-10llu                        ║\n", calculateMoves(n));
         printf("║  Execution Time:      %-10.6f seconds              ║\n", timeTaken);
-        printf("║  Moves/Second:        %-10.0f                        ║\n", moveCount / timeTaken);
+        printf("║  Moves/Second:        %-10.0f                        ║\n", perSecond(moveCount, timeTaken));
         printf("╚══════════════════════════════════════════════════════════╝\n");
     }
     
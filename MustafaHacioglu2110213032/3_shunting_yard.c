@@ -1,13 +1,57 @@
+// Build: gcc -O2 3_shunting_yard.c -o shunting_yard -lm
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <math.h>
+#include <time.h>
 
 #define MAX 100
 
-// Stack structure
+// Bytecode: one opcode byte, PUSH_CONST/LOAD_VAR followed by an index byte
+#define OP_PUSH_CONST 0
+#define OP_LOAD_VAR 1
+#define OP_ADD 2
+#define OP_SUB 3
+#define OP_MUL 4
+#define OP_DIV 5
+#define OP_POW 6
+#define OP_HALT 7
+
+#define MAX_VARIABLES 26
+#define MAX_NAME 32
+
+// Token types
+#define TOKEN_NUMBER 0
+#define TOKEN_IDENT 1
+#define TOKEN_OPERATOR 2
+#define TOKEN_LPAREN 3
+#define TOKEN_RPAREN 4
+
+// Token: a span of the input string (nothing is copied)
+typedef struct {
+    int type;
+    int start;      // Offset into the input
+    int length;
+    double value;   // Numbers only
+} Token;
+
+// Compiled expression: bytecode plus its constant pool and variable names.
+// Variables are numbered in order of first use; evaluation takes their
+// values as an array in that order.
+typedef struct {
+    unsigned char code[MAX * 2 + 1];
+    int length;
+    double constants[MAX];
+    int constantCount;
+    char variables[MAX_VARIABLES][MAX_NAME];
+    int variableCount;
+} Program;
+
+// Stack structure (holds token indices)
 typedef struct {
-    char items[MAX];
+    int items[MAX];
     int top;
 } Stack;
 
@@ -19,24 +63,24 @@ int isEmpty(Stack* s) {
     return s->top == -1;
 }
 
-void push(Stack* s, char value) {
+void push(Stack* s, int value) {
     if (s->top < MAX - 1) {
         s->items[++(s->top)] = value;
     }
 }
 
-char pop(Stack* s) {
+int pop(Stack* s) {
     if (!isEmpty(s)) {
         return s->items[(s->top)--];
     }
-    return '\0';
+    return -1;
 }
 
-char peek(Stack* s) {
+int peek(Stack* s) {
     if (!isEmpty(s)) {
         return s->items[s->top];
     }
-    return '\0';
+    return -1;
 }
 
 int isOperator(char ch) {
@@ -62,22 +106,110 @@ int isRightAssociative(char op) {
     return (op == '^');
 }
 
-void removeSpaces(char* str) {
-    int i = 0, j = 0;
-    while (str[i]) {
-        if (str[i] != ' ' && str[i] != '\t') {
-            str[j++] = str[i];
+// Single pass over the input: numbers (123, 4.5, 1e-3), identifiers
+// (x1, rate_2), operators and parentheses. Whitespace separates tokens.
+// Returns the number of tokens, or -1 on an unexpected character or a
+// number too long to parse.
+int tokenize(const char* input, Token* tokens, int maxTokens) {
+    int count = 0;
+    int i = 0;
+    
+    while (input[i] != '\0') {
+        char ch = input[i];
+        if (ch == ' ' || ch == '\t' || ch == '\n') {
+            i++;
+            continue;
+        }
+        if (count == maxTokens) {
+            printf("Too many tokens!\n");
+            return -1;
         }
-        i++;
+        
+        Token* token = &tokens[count];
+        token->start = i;
+        token->value = 0;
+        
+        if (isdigit((unsigned char)ch) || (ch == '.' && isdigit((unsigned char)input[i + 1]))) {
+            while (isdigit((unsigned char)input[i])) i++;
+            if (input[i] == '.') {
+                i++;
+                while (isdigit((unsigned char)input[i])) i++;
+            }
+            if ((input[i] == 'e' || input[i] == 'E') &&
+                (isdigit((unsigned char)input[i + 1]) ||
+                 ((input[i + 1] == '+' || input[i + 1] == '-') && isdigit((unsigned char)input[i + 2])))) {
+                i += 2;
+                while (isdigit((unsigned char)input[i])) i++;
+            }
+            
+            // strtod needs a terminated string; parse from a scratch copy
+            // (the input itself is left untouched)
+            char digits[64];
+            int length = i - token->start;
+            if (length >= (int)sizeof(digits)) {
+                printf("Number too long at position %d!\n", token->start);
+                return -1;
+            }
+            memcpy(digits, input + token->start, length);
+            digits[length] = '\0';
+            token->type = TOKEN_NUMBER;
+            token->value = strtod(digits, NULL);
+        }
+        else if (isalpha((unsigned char)ch) || ch == '_') {
+            while (isalnum((unsigned char)input[i]) || input[i] == '_') i++;
+            token->type = TOKEN_IDENT;
+        }
+        else if (isOperator(ch)) {
+            token->type = TOKEN_OPERATOR;
+            i++;
+        }
+        else if (ch == '(' || ch == ')') {
+            token->type = ch == '(' ? TOKEN_LPAREN : TOKEN_RPAREN;
+            i++;
+        }
+        else {
+            printf("Unexpected character '%c' at position %d!\n", ch, i);
+            return -1;
+        }
+        
+        token->length = i - token->start;
+        count++;
     }
-    str[j] = '\0';
+    
+    return count;
 }
 
-void infixToPostfix(char* infix, char* postfix, int verbose) {
+// Operator stack as a string of operator characters (for the step table)
+void stackToString(const char* infix, const Token* tokens, Stack* s, char* out) {
+    int j = 0;
+    for (int k = 0; k <= s->top; k++) {
+        out[j++] = infix[tokens[s->items[k]].start];
+    }
+    out[j] = '\0';
+}
+
+// Postfix tokens as text, separated by spaces
+void postfixToString(const char* infix, const Token* postfix, int count, char* out, int size) {
+    int j = 0;
+    out[0] = '\0';
+    for (int k = 0; k < count; k++) {
+        j += snprintf(out + j, j < size ? size - j : 0, "%s%.*s", k > 0 ? " " : "",
+                      postfix[k].length, infix + postfix[k].start);
+        if (j >= size) break;
+    }
+}
+
+// Shunting yard over tokens. Writes the postfix token vector and returns
+// its length, or -1 on mismatched parentheses or when operands and binary
+// operators do not alternate (e.g. "A B", "-x+2", "A*").
+int infixToPostfixTokens(const char* infix, const Token* tokens, int count, Token* postfix, int verbose) {
     Stack operators;
     initStack(&operators);
     
-    int i = 0, j = 0;
+    int j = 0;
+    int expectOperand = 1;
+    char stackText[MAX + 1];
+    char outputText[MAX * 2];
     
     if (verbose) {
         printf("\n=== STEP BY STEP CONVERSION ===\n\n");
@@ -87,99 +219,401 @@ void infixToPostfix(char* infix, char* postfix, int verbose) {
     
     int step = 1;
     
-    while (infix[i] != '\0') {
-        char token = infix[i];
+    for (int i = 0; i < count; i++) {
+        const Token* token = &tokens[i];
         
-        if (isalnum(token)) {
-            postfix[j++] = token;
-            if (verbose) {
-                postfix[j] = '\0';
-                printf("%-5d %-10c %-15s %-20s\n", step++, token, 
-                       isEmpty(&operators) ? "empty" : operators.items, postfix);
-            }
+        // Operands and '(' may only appear where an operand is expected,
+        // operators and ')' only after a complete operand
+        int opensOperand = token->type == TOKEN_NUMBER || token->type == TOKEN_IDENT ||
+                           token->type == TOKEN_LPAREN;
+        if (opensOperand && !expectOperand) {
+            printf("Missing operator before '%.*s' at position %d!\n",
+                   token->length, infix + token->start, token->start);
+            return -1;
         }
-        else if (token == '(') {
-            push(&operators, token);
-            if (verbose) {
-                printf("%-5d %-10c %-15s %-20s\n", step++, token, 
-                       operators.items, postfix);
-            }
+        if (!opensOperand && expectOperand) {
+            printf("Missing operand before '%c' at position %d!\n", infix[token->start], token->start);
+            return -1;
         }
-        else if (token == ')') {
-            while (!isEmpty(&operators) && peek(&operators) != '(') {
-                postfix[j++] = pop(&operators);
-            }
-            if (!isEmpty(&operators)) {
-                pop(&operators);
+        expectOperand = token->type == TOKEN_OPERATOR || token->type == TOKEN_LPAREN;
+        
+        if (token->type == TOKEN_NUMBER || token->type == TOKEN_IDENT) {
+            postfix[j++] = *token;
+        }
+        else if (token->type == TOKEN_LPAREN) {
+            push(&operators, i);
+        }
+        else if (token->type == TOKEN_RPAREN) {
+            while (!isEmpty(&operators) && tokens[peek(&operators)].type != TOKEN_LPAREN) {
+                postfix[j++] = tokens[pop(&operators)];
             }
-            if (verbose) {
-                postfix[j] = '\0';
-                printf("%-5d %-10c %-15s %-20s\n", step++, token, 
-                       isEmpty(&operators) ? "empty" : operators.items, postfix);
+            if (isEmpty(&operators)) {
+                printf("Mismatched parentheses!\n");
+                return -1;
             }
+            pop(&operators);
         }
-        else if (isOperator(token)) {
-            while (!isEmpty(&operators) && peek(&operators) != '(' &&
-                   (precedence(peek(&operators)) > precedence(token) ||
-                    (precedence(peek(&operators)) == precedence(token) && 
-                     !isRightAssociative(token)))) {
-                postfix[j++] = pop(&operators);
-            }
-            push(&operators, token);
-            if (verbose) {
-                postfix[j] = '\0';
-                printf("%-5d %-10c %-15s %-20s\n", step++, token, 
-                       operators.items, postfix);
+        else {
+            char op = infix[token->start];
+            while (!isEmpty(&operators) && tokens[peek(&operators)].type != TOKEN_LPAREN) {
+                char top = infix[tokens[peek(&operators)].start];
+                if (precedence(top) > precedence(op) ||
+                    (precedence(top) == precedence(op) && !isRightAssociative(op))) {
+                    postfix[j++] = tokens[pop(&operators)];
+                } else {
+                    break;
+                }
             }
+            push(&operators, i);
+        }
+        
+        if (verbose) {
+            stackToString(infix, tokens, &operators, stackText);
+            postfixToString(infix, postfix, j, outputText, sizeof(outputText));
+            printf("%-5d %-10.*s %-15s %-20s\n", step++, token->length, infix + token->start,
+                   isEmpty(&operators) ? "empty" : stackText, outputText);
         }
-        i++;
+    }
+    
+    if (count > 0 && expectOperand) {
+        printf("Missing operand at the end of the expression!\n");
+        return -1;
     }
     
     while (!isEmpty(&operators)) {
-        postfix[j++] = pop(&operators);
+        if (tokens[peek(&operators)].type == TOKEN_LPAREN) {
+            printf("Mismatched parentheses!\n");
+            return -1;
+        }
+        postfix[j++] = tokens[pop(&operators)];
         if (verbose) {
-            postfix[j] = '\0';
-            printf("%-5d %-10s %-15s %-20s\n", step++, "(pop)", 
-                   isEmpty(&operators) ? "empty" : operators.items, postfix);
+            stackToString(infix, tokens, &operators, stackText);
+            postfixToString(infix, postfix, j, outputText, sizeof(outputText));
+            printf("%-5d %-10s %-15s %-20s\n", step++, "(pop)",
+                   isEmpty(&operators) ? "empty" : stackText, outputText);
         }
     }
     
-    postfix[j] = '\0';
+    return j;
+}
+
+// Convert infix text to space-separated postfix text.
+// Returns the number of postfix tokens, or -1 on error.
+int infixToPostfix(char* infix, char* postfix, int verbose) {
+    Token tokens[MAX], output[MAX];
+    
+    postfix[0] = '\0';
+    int count = tokenize(infix, tokens, MAX);
+    if (count < 0) return -1;
+    
+    int length = infixToPostfixTokens(infix, tokens, count, output, verbose);
+    if (length < 0) return -1;
+    
+    postfixToString(infix, output, length, postfix, MAX * 2);
+    return length;
+}
+
+// Constant pool slot for value (reused if already present)
+int addConstant(Program* program, double value) {
+    for (int k = 0; k < program->constantCount; k++) {
+        if (program->constants[k] == value) return k;
+    }
+    program->constants[program->constantCount] = value;
+    return program->constantCount++;
+}
+
+// Variable slot for a name, added on first use. Returns -1 if the table
+// is full or the name does not fit in MAX_NAME - 1 characters.
+int addVariable(Program* program, const char* name, int length) {
+    if (length >= MAX_NAME) {
+        printf("Variable name '%.*s' is too long!\n", length, name);
+        return -1;
+    }
+    for (int k = 0; k < program->variableCount; k++) {
+        if ((int)strlen(program->variables[k]) == length &&
+            memcmp(program->variables[k], name, length) == 0) return k;
+    }
+    if (program->variableCount == MAX_VARIABLES) {
+        printf("Too many variables!\n");
+        return -1;
+    }
+    memcpy(program->variables[program->variableCount], name, length);
+    program->variables[program->variableCount][length] = '\0';
+    return program->variableCount++;
+}
+
+// Compile a postfix token vector to bytecode. Checks that every operator
+// has two operands and that exactly one value is left. Returns 0 or -1.
+int compilePostfix(const char* infix, const Token* postfix, int count, Program* program) {
+    int depth = 0;
+    
+    program->length = 0;
+    program->constantCount = 0;
+    program->variableCount = 0;
+    
+    for (int k = 0; k < count; k++) {
+        const Token* token = &postfix[k];
+        if (token->type == TOKEN_NUMBER) {
+            program->code[program->length++] = OP_PUSH_CONST;
+            program->code[program->length++] = (unsigned char)addConstant(program, token->value);
+            depth++;
+        }
+        else if (token->type == TOKEN_IDENT) {
+            int slot = addVariable(program, infix + token->start, token->length);
+            if (slot < 0) return -1;
+            program->code[program->length++] = OP_LOAD_VAR;
+            program->code[program->length++] = (unsigned char)slot;
+            depth++;
+        }
+        else {
+            if (depth < 2) {
+                printf("Missing operand for '%c'!\n", infix[token->start]);
+                return -1;
+            }
+            switch (infix[token->start]) {
+                case '+': program->code[program->length++] = OP_ADD; break;
+                case '-': program->code[program->length++] = OP_SUB; break;
+                case '*': program->code[program->length++] = OP_MUL; break;
+                case '/': program->code[program->length++] = OP_DIV; break;
+                default: program->code[program->length++] = OP_POW; break;
+            }
+            depth--;
+        }
+    }
+    
+    if (depth != 1) {
+        printf("Expression must produce exactly one value!\n");
+        return -1;
+    }
+    program->code[program->length++] = OP_HALT;
+    return 0;
+}
+
+// Tokenize, convert and compile infix text. Returns 0 or -1.
+int compileExpression(const char* infix, Program* program) {
+    Token tokens[MAX], postfix[MAX];
+    
+    int count = tokenize(infix, tokens, MAX);
+    if (count < 0) return -1;
+    int length = infixToPostfixTokens(infix, tokens, count, postfix, 0);
+    if (length < 0) return -1;
+    return compilePostfix(infix, postfix, length, program);
+}
+
+// Print the bytecode one instruction per line
+void printProgram(const Program* program) {
+    const char* names[] = {"PUSH_CONST", "LOAD_VAR", "ADD", "SUB", "MUL", "DIV", "POW", "HALT"};
+    
+    printf("%-6s %-12s %s\n", "Offset", "Instruction", "Operand");
+    printf("--------------------------------\n");
+    for (int pc = 0; pc < program->length; pc++) {
+        int op = program->code[pc];
+        printf("%-6d %-12s", pc, names[op]);
+        if (op == OP_PUSH_CONST) {
+            printf(" %g", program->constants[program->code[++pc]]);
+        } else if (op == OP_LOAD_VAR) {
+            printf(" %s", program->variables[program->code[++pc]]);
+        }
+        printf("\n");
+    }
+    printf("\n%d bytes, %d constants, %d variables\n", program->length,
+           program->constantCount, program->variableCount);
+}
+
+// Portable interpreter: switch dispatch
+double evaluateSwitch(const Program* program, const double* variables) {
+    double stack[MAX];
+    double* sp = stack;
+    const unsigned char* pc = program->code;
+    
+    for (;;) {
+        switch (*pc++) {
+            case OP_PUSH_CONST: *sp++ = program->constants[*pc++]; break;
+            case OP_LOAD_VAR: *sp++ = variables[*pc++]; break;
+            case OP_ADD: sp--; sp[-1] += sp[0]; break;
+            case OP_SUB: sp--; sp[-1] -= sp[0]; break;
+            case OP_MUL: sp--; sp[-1] *= sp[0]; break;
+            case OP_DIV: sp--; sp[-1] /= sp[0]; break;
+            case OP_POW: sp--; sp[-1] = pow(sp[-1], sp[0]); break;
+            default: return sp[-1];
+        }
+    }
+}
+
+// Interpreter with computed-goto dispatch where the compiler supports it:
+// each handler jumps straight to the next one through a label table
+double evaluateProgram(const Program* program, const double* variables) {
+#if defined(__GNUC__)
+    static void* handlers[] = {&&pushConst, &&loadVar, &&add, &&sub, &&mul, &&divide, &&power, &&halt};
+    double stack[MAX];
+    double* sp = stack;
+    const unsigned char* pc = program->code;
+    
+#define DISPATCH() goto *handlers[*pc++]
+    DISPATCH();
+pushConst:
+    *sp++ = program->constants[*pc++];
+    DISPATCH();
+loadVar:
+    *sp++ = variables[*pc++];
+    DISPATCH();
+add:
+    sp--; sp[-1] += sp[0];
+    DISPATCH();
+sub:
+    sp--; sp[-1] -= sp[0];
+    DISPATCH();
+mul:
+    sp--; sp[-1] *= sp[0];
+    DISPATCH();
+divide:
+    sp--; sp[-1] /= sp[0];
+    DISPATCH();
+power:
+    sp--; sp[-1] = pow(sp[-1], sp[0]);
+    DISPATCH();
+halt:
+    return sp[-1];
+#undef DISPATCH
+#else
+    return evaluateSwitch(program, variables);
+#endif
+}
+
+double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Time evaluate-many against reparsing the text for every evaluation.
+// Variables get fresh values on each iteration.
+void benchmarkEvaluation(const char* infix, const Program* program, long iterations) {
+    double variables[MAX_VARIABLES];
+    double sum;
+    double start, elapsed;
+    
+    printf("%-28s %-12s %-14s %-10s\n", "Method", "ns/eval", "Evals/second", "Checksum");
+    printf("------------------------------------------------------------------\n");
+    
+    // Computed goto (or switch when unavailable)
+    sum = 0;
+    start = nowSeconds();
+    for (long i = 0; i < iterations; i++) {
+        for (int v = 0; v < program->variableCount; v++) variables[v] = 1.0 + (i & 1023) * 0.001 + v;
+        sum += evaluateProgram(program, variables);
+    }
+    elapsed = nowSeconds() - start;
+#if defined(__GNUC__)
+    const char* label = "Bytecode (computed goto)";
+#else
+    const char* label = "Bytecode (switch fallback)";
+#endif
+    printf("%-28s %-12.2f %-14.0f %-10.4g\n", label, elapsed * 1e9 / iterations, iterations / elapsed, sum);
+    
+    // Switch dispatch
+    sum = 0;
+    start = nowSeconds();
+    for (long i = 0; i < iterations; i++) {
+        for (int v = 0; v < program->variableCount; v++) variables[v] = 1.0 + (i & 1023) * 0.001 + v;
+        sum += evaluateSwitch(program, variables);
+    }
+    elapsed = nowSeconds() - start;
+    printf("%-28s %-12.2f %-14.0f %-10.4g\n", "Bytecode (switch)", elapsed * 1e9 / iterations,
+           iterations / elapsed, sum);
+    
+    // Reparse and recompile every time (fewer iterations; it is much slower)
+    long reparses = iterations / 100 > 0 ? iterations / 100 : 1;
+    Program scratch;
+    sum = 0;
+    start = nowSeconds();
+    for (long i = 0; i < reparses; i++) {
+        compileExpression(infix, &scratch);
+        for (int v = 0; v < scratch.variableCount; v++) variables[v] = 1.0 + (i & 1023) * 0.001 + v;
+        sum += evaluateProgram(&scratch, variables);
+    }
+    elapsed = nowSeconds() - start;
+    printf("%-28s %-12.2f %-14.0f %-10.4g\n", "Reparse + compile each time", elapsed * 1e9 / reparses,
+           reparses / elapsed, sum);
 }
 
 void runTests() {
     printf("\n=== TEST CASES ===\n\n");
     
     char* tests[][2] = {
-        {"A+B", "AB+"},
-        {"A+B*C", "ABC*+"},
-        {"(A+B)*C", "AB+C*"},
-        {"A+B*C+D", "ABC*+D+"},
-        {"(A+B)*(C+D)", "AB+CD+*"},
-        {"A^B^C", "ABC^^"},
+        {"A+B", "A B +"},
+        {"A+B*C", "A B C * +"},
+        {"(A+B)*C", "A B + C *"},
+        {"A+B*C+D", "A B C * + D +"},
+        {"(A+B)*(C+D)", "A B + C D + *"},
+        {"A^B^C", "A B C ^ ^"},
+        {"12+x1", "12 x1 +"},
+        {"3.14 * (radius + 10)", "3.14 radius 10 + *"},
+        {"rate_2^2.5/total", "rate_2 2.5 ^ total /"},
+        {"1e-3*(x-y)/2", "1e-3 x y - * 2 /"},
     };
     
-    int numTests = 6;
-    char postfix[MAX];
+    int numTests = 10;
+    char postfix[MAX * 2];
     int passed = 0;
     
-    printf("%-20s %-20s %-10s\n", "Infix", "Expected", "Result");
-    printf("-------------------------------------------------------\n");
+    printf("%-22s %-22s %-10s\n", "Infix", "Expected", "Result");
+    printf("-----------------------------------------------------------\n");
     
     for (int i = 0; i < numTests; i++) {
         infixToPostfix(tests[i][0], postfix, 0);
         int match = strcmp(postfix, tests[i][1]) == 0;
         if (match) passed++;
-        printf("%-20s %-20s %-10s\n", tests[i][0], tests[i][1], 
+        printf("%-22s %-22s %-10s\n", tests[i][0], tests[i][1],
                match ? "PASS" : "FAIL");
     }
     
     printf("\nTests Passed: %d/%d\n", passed, numTests);
+    
+    printf("\n=== EVALUATION TESTS (x = 3, y = 4) ===\n\n");
+    
+    struct {
+        char* infix;
+        double expected;
+    } evalTests[] = {
+        {"2+3*4", 14},
+        {"(1+2)^2", 9},
+        {"2^3^2", 512},
+        {"x*y-1", 11},
+        {"10/4", 2.5},
+        {"(x + y) * (x - y) / 7", -1},
+        {"y*y*x - x/y", 47.25},
+    };
+    
+    int numEvalTests = 7;
+    int evalPassed = 0;
+    Program program;
+    
+    printf("%-26s %-12s %-12s %-10s\n", "Infix", "Expected", "Got", "Result");
+    printf("------------------------------------------------------------\n");
+    
+    for (int i = 0; i < numEvalTests; i++) {
+        double got = NAN, variables[MAX_VARIABLES];
+        int match = 0;
+        if (compileExpression(evalTests[i].infix, &program) == 0) {
+            for (int v = 0; v < program.variableCount; v++) {
+                variables[v] = strcmp(program.variables[v], "x") == 0 ? 3 : 4;
+            }
+            got = evaluateProgram(&program, variables);
+            // Both dispatch loops must agree
+            match = fabs(got - evalTests[i].expected) < 1e-9 && evaluateSwitch(&program, variables) == got;
+        }
+        if (match) evalPassed++;
+        printf("%-26s %-12g %-12g %-10s\n", evalTests[i].infix, evalTests[i].expected, got,
+               match ? "PASS" : "FAIL");
+    }
+    
+    printf("\nTests Passed: %d/%d\n", evalPassed, numEvalTests);
 }
 
 int main() {
     int choice;
-    char infix[MAX], postfix[MAX];
+    char infix[MAX], postfix[MAX * 2];
     
     printf("==================================================\n");
     printf("   SHUNTING YARD ALGORITHM - INFIX TO POSTFIX\n");
@@ -188,6 +622,8 @@ int main() {
     printf("1. Simple Conversion\n");
     printf("2. Step-by-Step Conversion\n");
     printf("3. Run Test Cases\n");
+    printf("4. Evaluate (Compile to Bytecode)\n");
+    printf("5. Bytecode Benchmark\n");
     printf("\nChoice: ");
     scanf("%d", &choice);
     getchar();
@@ -197,27 +633,51 @@ int main() {
             printf("\nEnter infix: ");
             fgets(infix, MAX, stdin);
             infix[strcspn(infix, "\n")] = 0;
-            removeSpaces(infix);
-            infixToPostfix(infix, postfix, 0);
+            if (infixToPostfix(infix, postfix, 0) < 0) break;
             printf("\nInfix:   %s\n", infix);
             printf("Postfix: %s\n", postfix);
             break;
-            
+        
         case 2:
             printf("\nEnter infix: ");
             fgets(infix, MAX, stdin);
             infix[strcspn(infix, "\n")] = 0;
-            removeSpaces(infix);
-            infixToPostfix(infix, postfix, 1);
+            if (infixToPostfix(infix, postfix, 1) < 0) break;
             printf("\nFinal Result:\n");
             printf("Infix:   %s\n", infix);
             printf("Postfix: %s\n", postfix);
             break;
-            
+        
         case 3:
             runTests();
             break;
             
+        case 4:
+        case 5: {
+            Program program;
+            printf("\nEnter infix: ");
+            fgets(infix, MAX, stdin);
+            infix[strcspn(infix, "\n")] = 0;
+            if (compileExpression(infix, &program) != 0) break;
+            
+            printf("\n");
+            printProgram(&program);
+            printf("\n");
+            
+            if (choice == 5) {
+                benchmarkEvaluation(infix, &program, 10000000L);
+                break;
+            }
+            
+            double variables[MAX_VARIABLES];
+            for (int v = 0; v < program.variableCount; v++) {
+                printf("Value of %s: ", program.variables[v]);
+                scanf("%lf", &variables[v]);
+            }
+            printf("\nResult: %g\n", evaluateProgram(&program, variables));
+            break;
+        }
+        
         default:
             printf("Invalid choice!\n");
     }